@@ -0,0 +1,353 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_dsp/juce_dsp.h>
+#include <atomic>
+#include <mutex>
+#include "Resampler.h"
+#include "TraceRecorder.h"
+
+/** Impulse-response reverb split into two convolvers.
+
+    The head (the first 2 * tailBlockSize samples of the IR) runs on the audio
+    thread in a zero-latency, block-sized partitioned convolver. The rest of the IR
+    runs on a worker thread in large partitions. Its input and output move through
+    lock-free FIFOs, and the output FIFO is primed with exactly the head length, so
+    the tail comes back in place behind the head. That leaves the worker a full tail
+    block of time per block, so a multi-second hall at 64-sample buffers costs the
+    callback only the head. The worker starts with the first IR and sleeps until the
+    audio thread has a full tail block for it. Offline renders, which run faster than
+    real time, convolve the tail inline instead so no tail sample is ever dropped.
+
+    IR files are read, resampled to the session rate and normalised on a loader
+    thread, so the tail keeps running meanwhile; the convolvers swap new IRs in
+    without locking. */
+class ConvolutionReverb : private juce::Thread
+{
+public:
+    ConvolutionReverb() : juce::Thread("RaveLand Convolution Tail") {}
+
+    ~ConvolutionReverb() override
+    {
+        loader.removeAllJobs(true, 4000);
+        stopThread(2000);
+    }
+
+    void prepare(double newSampleRate, int maxBlockSize)
+    {
+        loader.removeAllJobs(true, 4000);
+        stopThread(2000);
+
+        sampleRate = newSampleRate;
+        tailBlockSize = juce::jmax(4096, juce::nextPowerOfTwo(maxBlockSize));
+        headLength = 2 * tailBlockSize;
+
+        head.prepare({ sampleRate, (juce::uint32) maxBlockSize, 2 });
+        tail.prepare({ sampleRate, (juce::uint32) tailBlockSize, 2 });
+        head.reset();
+        tail.reset();
+
+        wet.setSize(2, maxBlockSize);
+        tailBlock.setSize(2, tailBlockSize);
+
+        const int fifoSize = 4 * tailBlockSize + maxBlockSize;
+        inputFifo.setTotalSize(fifoSize);
+        outputFifo.setTotalSize(fifoSize + headLength);
+        inputBuffer.setSize(2, fifoSize);
+        outputBuffer.setSize(2, fifoSize + headLength);
+        inputFifo.reset();
+        outputFifo.reset();
+        outputBuffer.clear();
+        droppedOutput.store(0);
+        samplesPushed = samplesPulled = appliedResetPoint = 0;
+        tailResetPoint.store(0);
+        mutedTailOutput = 0;
+
+        // Tail output lands headLength samples after its input: exactly where the head ends
+        int start1, size1, start2, size2;
+        outputFifo.prepareToWrite(headLength, start1, size1, start2, size2);
+        outputFifo.finishedWrite(size1 + size2);
+
+        wetLevel.reset(sampleRate, 0.05);
+        ready.store(false);
+
+        // Re-convert the current IR for the new rate
+        const auto current = getImpulseResponseFile();
+        if (current != juce::File())
+            loadImpulseResponse(current);
+    }
+
+    /** Queues an IR file to be loaded in the background. Safe from the message thread. */
+    void loadImpulseResponse(const juce::File& file)
+    {
+        {
+            const std::lock_guard<std::mutex> sl(fileLock);
+            impulseFile = file;
+        }
+
+        loader.addJob([this, file, rate = sampleRate] { loadImpulse(file, rate); });
+    }
+
+    bool isReady() const noexcept { return ready.load(); }
+
+    double getImpulseLengthSeconds() const noexcept { return impulseSeconds.load(); }
+
+    juce::File getImpulseResponseFile() const
+    {
+        const std::lock_guard<std::mutex> sl(fileLock);
+        return impulseFile;
+    }
+
+    void setMix(float mix) { wetLevel.setTargetValue(mix); }
+
+    /** Clears the reverb's state but keeps the IR. Safe on the audio thread: the head is
+        cleared here and the tail already queued is muted as it arrives, while the worker
+        is told where the new input starts so it drops the old tail before reaching it. */
+    void reset()
+    {
+        head.reset();
+
+        // The next headLength samples of tail output were all convolved from old input
+        mutedTailOutput = headLength;
+        tailResetPoint.store(samplesPushed);
+    }
+
+    /** Adds the reverb to a stereo buffer (dry passes at unity, like the algorithmic reverb).
+        nonRealtime runs the tail on the calling thread, for renders faster than real time. */
+    void process(juce::AudioBuffer<float>& buffer, bool nonRealtime)
+    {
+        if (!ready.load() || buffer.getNumChannels() < 2)
+            return;
+
+        const int numSamples = buffer.getNumSamples();
+
+        for (int ch = 0; ch < 2; ++ch)
+            wet.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+
+        juce::dsp::AudioBlock<float> block(wet.getArrayOfWritePointers(), 2, (size_t) numSamples);
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        head.process(context);
+
+        pushInput(buffer, numSamples);
+
+        if (inputFifo.getNumReady() >= tailBlockSize)
+        {
+            if (nonRealtime)
+                processReadyTailBlocks();
+            else
+                notify(); // once per tail block
+        }
+
+        addTailOutput(numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float gain = wetLevel.getNextValue();
+            buffer.addSample(0, i, wet.getSample(0, i) * gain);
+            buffer.addSample(1, i, wet.getSample(1, i) * gain);
+        }
+    }
+
+private:
+    double sampleRate { 44100.0 };
+    int tailBlockSize { 4096 };
+    int headLength { 8192 };
+
+    juce::dsp::Convolution head;   // audio thread
+    juce::dsp::Convolution tail;   // worker thread
+    juce::AudioBuffer<float> wet;
+    juce::AudioBuffer<float> tailBlock;
+
+    juce::AbstractFifo inputFifo { 1 };
+    juce::AbstractFifo outputFifo { 1 };
+    juce::AudioBuffer<float> inputBuffer;
+    juce::AudioBuffer<float> outputBuffer;
+    std::atomic<int> droppedOutput { 0 }; // tail samples the audio thread had to skip
+
+    juce::int64 samplesPushed { 0 };                // audio thread
+    juce::int64 samplesPulled { 0 };                // under tailLock
+    juce::int64 appliedResetPoint { 0 };            // under tailLock
+    std::atomic<juce::int64> tailResetPoint { 0 }; // input position of the last reset()
+    int mutedTailOutput { 0 };                      // audio thread
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> wetLevel { 0.22f };
+
+    std::mutex tailLock; // held by whichever thread convolves the tail: only contended when switching modes
+
+    juce::ThreadPool loader { 1 };
+    mutable std::mutex fileLock;
+    juce::File impulseFile;
+    std::atomic<bool> ready { false };
+    std::atomic<double> impulseSeconds { 0.0 };
+
+    void pushInput(const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        int start1, size1, start2, size2;
+        inputFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (size1 > 0)
+                inputBuffer.copyFrom(ch, start1, buffer, ch, 0, size1);
+            if (size2 > 0)
+                inputBuffer.copyFrom(ch, start2, buffer, ch, size1, size2);
+        }
+
+        inputFifo.finishedWrite(size1 + size2);
+        samplesPushed += size1 + size2;
+    }
+
+    void addTailOutput(int numSamples)
+    {
+        int start1, size1, start2, size2;
+        outputFifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+        // Read but don't add what is left of the tail from before a reset()
+        const int muted = juce::jmin(mutedTailOutput, numSamples);
+        mutedTailOutput -= muted;
+        const int skip1 = juce::jmin(muted, size1);
+        const int skip2 = juce::jmin(muted - skip1, size2);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (size1 > skip1)
+                wet.addFrom(ch, skip1, outputBuffer, ch, start1 + skip1, size1 - skip1);
+            if (size2 > skip2)
+                wet.addFrom(ch, size1 + skip2, outputBuffer, ch, start2 + skip2, size2 - skip2);
+        }
+
+        outputFifo.finishedRead(size1 + size2);
+
+        // A late worker costs a gap, not a stall; its late samples are dropped to stay aligned
+        const int missing = numSamples - (size1 + size2);
+        if (missing > 0)
+            droppedOutput.fetch_add(missing);
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            processReadyTailBlocks();
+            wait(-1);
+        }
+    }
+
+    void processReadyTailBlocks()
+    {
+        const std::lock_guard<std::mutex> sl(tailLock);
+
+        while (inputFifo.getNumReady() >= tailBlockSize && !threadShouldExit())
+            processTailBlock();
+    }
+
+    void processTailBlock()
+    {
+        RAVELAND_TRACE_SCOPE("convolution tail");
+        int start1, size1, start2, size2;
+        inputFifo.prepareToRead(tailBlockSize, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (size1 > 0)
+                tailBlock.copyFrom(ch, 0, inputBuffer, ch, start1, size1);
+            if (size2 > 0)
+                tailBlock.copyFrom(ch, size1, inputBuffer, ch, start2, size2);
+        }
+
+        inputFifo.finishedRead(size1 + size2);
+
+        const auto blockStart = samplesPulled;
+        samplesPulled += size1 + size2;
+
+        // After a reset() the old tail goes, and so does any input queued before it
+        const auto resetPoint = tailResetPoint.load();
+        if (resetPoint != appliedResetPoint)
+        {
+            appliedResetPoint = resetPoint;
+            tail.reset();
+        }
+
+        if (resetPoint > blockStart)
+            tailBlock.clear(0, (int) juce::jmin((juce::int64) tailBlockSize, resetPoint - blockStart));
+
+        juce::dsp::AudioBlock<float> block(tailBlock);
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        tail.process(context);
+
+        int offset = juce::jmin(tailBlockSize, droppedOutput.exchange(0));
+        const int count = juce::jmin(tailBlockSize - offset, outputFifo.getFreeSpace());
+
+        outputFifo.prepareToWrite(count, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (size1 > 0)
+                outputBuffer.copyFrom(ch, start1, tailBlock, ch, offset, size1);
+            if (size2 > 0)
+                outputBuffer.copyFrom(ch, start2, tailBlock, ch, offset + size1, size2);
+        }
+
+        outputFifo.finishedWrite(size1 + size2);
+    }
+
+    /** Loader thread: the convolvers accept new IRs from any thread. */
+    void loadImpulse(const juce::File& file, double targetRate)
+    {
+        RAVELAND_TRACE_SCOPE("impulse load");
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+        if (reader == nullptr || reader->lengthInSamples <= 0)
+            return;
+
+        juce::AudioBuffer<float> source((int) reader->numChannels, (int) reader->lengthInSamples);
+        reader->read(source.getArrayOfWritePointers(), source.getNumChannels(), 0, source.getNumSamples());
+
+        auto ir = Resampler::process(source, reader->sampleRate, targetRate);
+
+        // Always stereo; mono IRs feed both sides
+        if (ir.getNumChannels() == 1)
+        {
+            ir.setSize(2, ir.getNumSamples(), true);
+            ir.copyFrom(1, 0, ir, 0, 0, ir.getNumSamples());
+        }
+        else if (ir.getNumChannels() > 2)
+        {
+            ir.setSize(2, ir.getNumSamples(), true);
+        }
+
+        // Normalise the whole IR once, so head and tail keep their relative level
+        double energy = 0.0;
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < ir.getNumSamples(); ++i)
+                energy += (double) ir.getSample(ch, i) * ir.getSample(ch, i);
+
+        if (energy > 0.0)
+            ir.applyGain((float) (1.0 / std::sqrt(energy * 0.5)));
+
+        const int headSize = juce::jmin(headLength, ir.getNumSamples());
+        juce::AudioBuffer<float> headIr(2, headSize);
+        for (int ch = 0; ch < 2; ++ch)
+            headIr.copyFrom(ch, 0, ir, ch, 0, headSize);
+
+        const int tailSize = juce::jmax(1, ir.getNumSamples() - headLength);
+        juce::AudioBuffer<float> tailIr(2, tailSize);
+        tailIr.clear();
+        for (int ch = 0; ch < 2 && ir.getNumSamples() > headLength; ++ch)
+            tailIr.copyFrom(ch, 0, ir, ch, headLength, tailSize);
+
+        head.loadImpulseResponse(std::move(headIr), targetRate, juce::dsp::Convolution::Stereo::yes,
+                                 juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+        tail.loadImpulseResponse(std::move(tailIr), targetRate, juce::dsp::Convolution::Stereo::yes,
+                                 juce::dsp::Convolution::Trim::no, juce::dsp::Convolution::Normalise::no);
+
+        impulseSeconds.store(ir.getNumSamples() / targetRate);
+        ready.store(true);
+
+        // The worker only exists once there is a tail to convolve
+        if (!isThreadRunning())
+            startThread();
+    }
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <memory>
+
+/** Drive + tanh waveshaper run at 1x/2x/4x/8x the session rate.
+
+    Every factor is prepared up front so switching never allocates. The
+    oversamplers use polyphase equiripple half-band FIR stages (linear phase), so
+    the dry path is simply delayed by the same latency and dry/wet mixes without
+    comb filtering. At zero mix the shaper and oversampling are skipped and only
+    that dry delay runs, keeping the reported latency constant. */
+class DistortionStage
+{
+public:
+    static juce::StringArray getOversamplingNames() { return { "1x", "2x", "4x", "8x" }; }
+
+    void prepare(double newSampleRate, int maxBlockSize, int numChannels)
+    {
+        sampleRate = newSampleRate;
+
+        for (size_t order = 1; order < oversamplers.size(); ++order)
+        {
+            oversamplers[order] = std::make_unique<juce::dsp::Oversampling<float>>(
+                (size_t) numChannels, order, juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true, true);
+            oversamplers[order]->initProcessing((size_t) maxBlockSize);
+        }
+
+        int maxLatency = 0;
+        for (size_t order = 1; order < oversamplers.size(); ++order)
+            maxLatency = juce::jmax(maxLatency, juce::roundToInt(oversamplers[order]->getLatencyInSamples()));
+
+        dryLength = maxLatency + maxBlockSize;
+        dryLine.setSize(numChannels, dryLength);
+        dry.setSize(numChannels, maxBlockSize);
+
+        juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) maxBlockSize, (juce::uint32) numChannels };
+        toneFilter.prepare(spec);
+        currentTone = -2.0f; // force a coefficient update
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& os : oversamplers)
+            if (os != nullptr)
+                os->reset();
+
+        toneFilter.reset();
+        dryLine.clear();
+        dryWrite = 0;
+    }
+
+    /** 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x. */
+    void setOversamplingIndex(int index)
+    {
+        index = juce::jlimit(0, (int) oversamplers.size() - 1, index);
+        if (index == oversamplingIndex)
+            return;
+
+        oversamplingIndex = index;
+        reset();
+    }
+
+    int getOversamplingIndex() const { return oversamplingIndex; }
+
+    int getLatencySamples() const
+    {
+        const auto& os = oversamplers[(size_t) oversamplingIndex];
+        return os != nullptr ? juce::roundToInt(os->getLatencyInSamples()) : 0;
+    }
+
+    void setParameters(float newMix, float newDrive, float newTone)
+    {
+        mix = newMix;
+        drive = 1.0f + newDrive * 4.0f;
+
+        if (newTone != currentTone)
+        {
+            currentTone = newTone;
+            // Tilt: tone -1..1 pulls the top end down or up by up to 9 dB
+            *toneFilter.state = juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf(
+                sampleRate, 3000.0f, 0.707f, juce::Decibels::decibelsToGain(newTone * 9.0f));
+        }
+    }
+
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), dry.getNumChannels());
+
+        delayDry(buffer, numChannels, numSamples);
+
+        if (mix <= 0.0f)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.copyFrom(ch, 0, dry, ch, 0, numSamples);
+
+            bypassed = true;
+            return;
+        }
+
+        juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), (size_t) numChannels, (size_t) numSamples);
+        auto* os = oversamplers[(size_t) oversamplingIndex].get();
+
+        // Filter history from before a bypass would replay as a click
+        if (bypassed)
+        {
+            if (os != nullptr)
+                os->reset();
+            toneFilter.reset();
+            bypassed = false;
+        }
+        auto shaped = os != nullptr ? os->processSamplesUp(block) : block;
+
+        for (size_t ch = 0; ch < shaped.getNumChannels(); ++ch)
+        {
+            auto* data = shaped.getChannelPointer(ch);
+            for (size_t i = 0; i < shaped.getNumSamples(); ++i)
+                data[i] = std::tanh(data[i] * drive);
+        }
+
+        if (os != nullptr)
+            os->processSamplesDown(block);
+
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        toneFilter.process(context);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer.applyGain(ch, 0, numSamples, mix);
+            buffer.addFrom(ch, 0, dry, ch, 0, numSamples, 1.0f - mix);
+        }
+    }
+
+private:
+    double sampleRate { 44100.0 };
+    float mix { 0.0f };
+    float drive { 1.0f };
+    float currentTone { -2.0f };
+    int oversamplingIndex { 0 };
+    bool bypassed { false };
+
+    std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 4> oversamplers; // [0] unused: 1x
+    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> toneFilter
+    {
+        juce::dsp::IIR::Coefficients<float>::makeHighShelf(44100.0, 3000.0f, 0.707f, 1.0f)
+    };
+
+    juce::AudioBuffer<float> dryLine;
+    juce::AudioBuffer<float> dry;
+    int dryLength { 0 };
+    int dryWrite { 0 };
+
+    /** Copies the input into dry, delayed by the current oversampling latency. */
+    void delayDry(const juce::AudioBuffer<float>& input, int numChannels, int numSamples)
+    {
+        const int latency = getLatencySamples();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* line = dryLine.getWritePointer(ch);
+            const auto* in = input.getReadPointer(ch);
+            auto* out = dry.getWritePointer(ch);
+
+            const int first = juce::jmin(numSamples, dryLength - dryWrite);
+            juce::FloatVectorOperations::copy(line + dryWrite, in, first);
+            juce::FloatVectorOperations::copy(line, in + first, numSamples - first);
+
+            int read = dryWrite - latency;
+            if (read < 0)
+                read += dryLength;
+
+            const int firstRead = juce::jmin(numSamples, dryLength - read);
+            juce::FloatVectorOperations::copy(out, line + read, firstRead);
+            juce::FloatVectorOperations::copy(out + firstRead, line, numSamples - firstRead);
+        }
+
+        dryWrite = (dryWrite + numSamples) % dryLength;
+    }
+};
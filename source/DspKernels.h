@@ -0,0 +1,72 @@
+#pragma once
+
+/** The hot inner loops, compiled once per instruction set and picked at startup.
+
+    DspKernelsImpl.h holds the loops. DspKernelsBaseline.cpp, DspKernelsAvx2.cpp and
+    DspKernelsAvx512.cpp each compile it with their own architecture flags (set per file
+    in CMakeLists.txt), so the plugin itself still targets the SSE2 / NEON baseline and
+    loads anywhere. get() returns the widest table the CPU can run; setting the
+    RAVELAND_ISA environment variable to baseline, avx2 or avx512 caps the choice, for
+    testing and for comparing renders across paths.
+
+    The per-ISA files include this header, so it must stay free of inline code: an
+    inline function compiled there with AVX flags could be the copy the linker keeps. */
+struct DspKernels
+{
+    /** Feedback delay network state, owned by FdnReverb. */
+    struct FdnState
+    {
+        static constexpr int numLines = 8;
+
+        float* lines { nullptr }; // interleaved: sample n of line k at n * numLines + k
+        int mask { 0 };
+        int writeIndex { 0 };
+        int lengths[numLines] {};
+        float gains[numLines] {};
+        float dampState[numLines] {};
+        float dampCoeff { 0.0f };
+        float inputGain { 0.0f };
+        float widthMain { 0.0f };
+        float widthCross { 0.0f };
+    };
+
+    /** Ensemble chorus state, owned by EnsembleChorus. */
+    struct ChorusState
+    {
+        static constexpr int lanes = 8;
+
+        float* lines[2] {};
+        int mask { 0 };
+        int writeIndex { 0 };
+        float phase { 0.0f };
+        float phaseIncrement { 0.0f };
+        float msToSamples { 0.0f };
+        float phaseOffsets[2][lanes] {};
+        float tapCentreMs[lanes] {};
+        float tapGains[lanes] {};
+    };
+
+    const char* name;
+
+    /** Writes the sum of numLanes sines, each scaled by gain, and advances each lane's
+        phase (in radians, kept within [0, 2 pi)) by its increment per sample. */
+    void (*supersaw)(double* phases, const double* increments, int numLanes, float gain,
+                     float* output, int numSamples);
+
+    float (*dotProduct)(const float* a, const float* b, int numSamples);
+
+    /** Adds the reverb to left and right; wet holds the per-sample output gain. */
+    void (*fdnReverb)(FdnState& state, float* left, float* right, const float* wet, int numSamples);
+
+    /** Replaces left and right with the chorused mix; depthSamples and wet are per sample. */
+    void (*ensembleChorus)(ChorusState& state, float* left, float* right,
+                           const float* depthSamples, const float* wet, int numSamples);
+
+    /** The kernels in use; the first call chooses them. */
+    static const DspKernels& get();
+
+    /** Each returns nullptr when this build has no such path, e.g. AVX on an ARM build. */
+    static const DspKernels* getBaseline();
+    static const DspKernels* getAvx2();
+    static const DspKernels* getAvx512();
+};
@@ -0,0 +1,21 @@
+#include "DspKernels.h"
+
+// Built with AVX2 and FMA enabled (see CMakeLists.txt); empty on other architectures
+#if defined(__AVX2__)
+ #include "DspKernelsImpl.h"
+
+namespace
+{
+    constexpr DspKernels kernels = makeKernels("avx2");
+}
+
+const DspKernels* DspKernels::getAvx2()
+{
+    return &kernels;
+}
+#else
+const DspKernels* DspKernels::getAvx2()
+{
+    return nullptr;
+}
+#endif
@@ -0,0 +1,21 @@
+#include "DspKernels.h"
+
+// Built with AVX-512 F/VL and FMA enabled (see CMakeLists.txt); empty on other architectures
+#if defined(__AVX512F__)
+ #include "DspKernelsImpl.h"
+
+namespace
+{
+    constexpr DspKernels kernels = makeKernels("avx512");
+}
+
+const DspKernels* DspKernels::getAvx512()
+{
+    return &kernels;
+}
+#else
+const DspKernels* DspKernels::getAvx512()
+{
+    return nullptr;
+}
+#endif
@@ -0,0 +1,55 @@
+#include <juce_core/juce_core.h>
+#include "DspKernelsImpl.h"
+
+namespace
+{
+    constexpr DspKernels baselineKernels = makeKernels("baseline");
+}
+
+const DspKernels* DspKernels::getBaseline()
+{
+    return &baselineKernels;
+}
+
+namespace
+{
+    const DspKernels* chooseKernels()
+    {
+        // The getters are only called once the CPU is known to have the instruction set,
+        // so nothing from a wider file ever runs on a CPU without it
+        struct Choice
+        {
+            const char* name;
+            const DspKernels* (*getKernels)();
+            bool supported;
+        };
+
+        const Choice choices[] = {
+            { "avx512", DspKernels::getAvx512, juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX512VL()
+                                                   && juce::SystemStats::hasFMA3() },
+            { "avx2", DspKernels::getAvx2, juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3() },
+            { "baseline", DspKernels::getBaseline, true },
+        };
+
+        // RAVELAND_ISA caps the choice: the named path if this CPU and build have it, else the next one down
+        const auto requested = juce::SystemStats::getEnvironmentVariable("RAVELAND_ISA", {}).trim().toLowerCase();
+        bool reached = requested.isEmpty();
+
+        for (const auto& choice : choices)
+        {
+            reached = reached || requested == choice.name;
+            if (reached && choice.supported)
+                if (auto* kernels = choice.getKernels())
+                    return kernels;
+        }
+
+        DBG("RAVELAND_ISA: unknown instruction set " + requested.quoted() + ", using baseline");
+        return DspKernels::getBaseline();
+    }
+}
+
+const DspKernels& DspKernels::get()
+{
+    static const DspKernels* const kernels = chooseKernels();
+    return *kernels;
+}
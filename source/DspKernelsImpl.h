@@ -0,0 +1,222 @@
+#pragma once
+
+// Included once by each DspKernels*.cpp and compiled with that file's architecture flags.
+// Everything here has internal linkage and calls nothing from the standard library or
+// JUCE, so no shared inline code is built with instructions the CPU may lack.
+// The loops are written as independent lanes (fixed-width lane loops, or samples that
+// don't depend on each other), which the compiler vectorises at whatever width the file
+// is built for.
+
+#include "DspKernels.h"
+
+namespace
+{
+    constexpr float pi = 3.14159265f;
+
+    inline float absolute(float x) noexcept { return x < 0.0f ? -x : x; }
+
+    /** x - floor(x), for x >= 0. */
+    inline float wrapPositive(float x) noexcept { return x - (float) (int) x; }
+
+    /** sin(p) for p in [0, 2 pi]: folded into [-pi/2, pi/2], then an 11th-order
+        polynomial, accurate to about 1e-7. */
+    inline float sineOfPhase(float p) noexcept
+    {
+        // As min / max, which vectorise; plain selects on a comparison don't
+        float x = p - pi; // sin(p) = -sin(p - pi)
+        const float above = pi - x;
+        x = above < x ? above : x;
+        const float below = -pi - x;
+        x = below > x ? below : x;
+
+        const float x2 = x * x;
+        const float y = x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f
+                              + x2 * (2.7557319e-6f + x2 * -2.5052108e-8f)))));
+        return -y;
+    }
+
+    /** sin(2 pi x) for x in [0, 1), from a corrected parabola (about 0.1% error). */
+    inline float sineOfCycle(float x) noexcept
+    {
+        const float t = 2.0f * x - 1.0f;
+        const float y = -4.0f * t * (1.0f - absolute(t));
+        return 0.225f * (y * absolute(y) - y) + y;
+    }
+
+    /** Lane by lane, each over the whole block: the phase comes straight from the block's
+        start phase, so samples are independent and the loop runs across the vector width. */
+    void supersawKernel(double* phases, const double* increments, int numLanes, float gain,
+                        float* output, int numSamples)
+    {
+        constexpr double twoPi = 6.283185307179586;
+        constexpr double cyclesPerRadian = 1.0 / twoPi;
+
+        for (int i = 0; i < numSamples; ++i)
+            output[i] = 0.0f;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const double start = phases[lane];
+            const double increment = increments[lane];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                double p = start + (double) (i + 1) * increment;
+                p -= twoPi * (double) (int) (p * cyclesPerRadian);
+                output[i] += gain * sineOfPhase((float) p);
+            }
+
+            double end = start + (double) numSamples * increment;
+            phases[lane] = end - twoPi * (double) (int) (end * cyclesPerRadian);
+        }
+    }
+
+    float dotProductKernel(const float* a, const float* b, int numSamples)
+    {
+        float acc[16] = {};
+        int i = 0;
+
+        for (; i + 16 <= numSamples; i += 16)
+            for (int k = 0; k < 16; ++k)
+                acc[k] += a[i + k] * b[i + k];
+
+        float sum = 0.0f;
+        for (; i < numSamples; ++i)
+            sum += a[i] * b[i];
+
+        for (int k = 0; k < 16; ++k)
+            sum += acc[k];
+
+        return sum;
+    }
+
+    void fdnReverbKernel(DspKernels::FdnState& state, float* left, float* right, const float* wet, int numSamples)
+    {
+        constexpr int numLines = DspKernels::FdnState::numLines;
+        constexpr float norm = 0.35355339f; // 1 / sqrt(8): keeps the Hadamard mix lossless
+
+        // Locals, so the compiler needn't assume stores to the lines alias the state
+        float* const data = state.lines;
+        const int mask = state.mask;
+        int writeIndex = state.writeIndex;
+        int lengths[numLines];
+        float gains[numLines], damp[numLines], s[numLines];
+
+        for (int k = 0; k < numLines; ++k)
+        {
+            lengths[k] = state.lengths[k];
+            gains[k] = state.gains[k];
+            damp[k] = state.dampState[k];
+        }
+
+        const float dampCoeff = state.dampCoeff;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // Read each line's oldest sample
+            for (int k = 0; k < numLines; ++k)
+                s[k] = data[(((writeIndex - lengths[k]) & mask) * numLines) + k];
+
+            // One-pole lowpass per line
+            for (int k = 0; k < numLines; ++k)
+            {
+                damp[k] = s[k] + dampCoeff * (damp[k] - s[k]);
+                s[k] = damp[k];
+            }
+
+            const float outL = s[0] - s[2] + s[4] - s[6];
+            const float outR = s[1] - s[3] + s[5] - s[7];
+
+            // In-place fast Walsh-Hadamard transform
+            for (int h = 1; h < numLines; h <<= 1)
+            {
+                for (int j0 = 0; j0 < numLines; j0 += h << 1)
+                {
+                    for (int j = j0; j < j0 + h; ++j)
+                    {
+                        const float a = s[j];
+                        const float b = s[j + h];
+                        s[j] = a + b;
+                        s[j + h] = a - b;
+                    }
+                }
+            }
+
+            const float inL = left[i] * state.inputGain;
+            const float inR = right[i] * state.inputGain;
+            float* write = data + writeIndex * numLines;
+
+            for (int k = 0; k < numLines; ++k)
+                write[k] = s[k] * norm * gains[k] + ((k & 1) == 0 ? inL : inR);
+
+            writeIndex = (writeIndex + 1) & mask;
+
+            left[i] += wet[i] * (outL * state.widthMain + outR * state.widthCross);
+            right[i] += wet[i] * (outR * state.widthMain + outL * state.widthCross);
+        }
+
+        for (int k = 0; k < numLines; ++k)
+            state.dampState[k] = damp[k];
+
+        state.writeIndex = writeIndex;
+    }
+
+    void ensembleChorusKernel(DspKernels::ChorusState& state, float* left, float* right,
+                              const float* depthSamples, const float* wet, int numSamples)
+    {
+        constexpr int lanes = DspKernels::ChorusState::lanes;
+
+        float* const channels[2] = { left, right };
+        const int mask = state.mask;
+        int writeIndex = state.writeIndex;
+        float phase = state.phase;
+        float lfo[lanes], delaySamples[lanes], fraction[lanes];
+        int readIndex[lanes];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                float* const line = state.lines[ch];
+                const float in = channels[ch][i];
+                line[writeIndex] = in;
+
+                for (int k = 0; k < lanes; ++k)
+                    lfo[k] = sineOfCycle(wrapPositive(phase + state.phaseOffsets[ch][k]));
+
+                for (int k = 0; k < lanes; ++k)
+                    delaySamples[k] = state.tapCentreMs[k] * state.msToSamples + depthSamples[i] * lfo[k];
+
+                for (int k = 0; k < lanes; ++k)
+                {
+                    const int whole = (int) delaySamples[k];
+                    fraction[k] = delaySamples[k] - (float) whole;
+                    readIndex[k] = (writeIndex - whole) & mask;
+                }
+
+                float sum = 0.0f;
+                for (int k = 0; k < lanes; ++k)
+                {
+                    const float a = line[readIndex[k]];
+                    const float b = line[(readIndex[k] - 1) & mask];
+                    sum += state.tapGains[k] * (a + fraction[k] * (b - a));
+                }
+
+                channels[ch][i] = in * (1.0f - wet[i]) + sum * wet[i];
+            }
+
+            writeIndex = (writeIndex + 1) & mask;
+            phase = wrapPositive(phase + state.phaseIncrement);
+        }
+
+        state.writeIndex = writeIndex;
+        state.phase = phase;
+    }
+
+    /** constexpr, so each file's table is constant-initialised: no code built with that
+        file's flags runs until the table is chosen and called. */
+    constexpr DspKernels makeKernels(const char* name)
+    {
+        return { name, supersawKernel, dotProductKernel, fdnReverbKernel, ensembleChorusKernel };
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include "FxChain.h"
+
+/** Per-block DSP load, measured on the audio thread and read by the editor.
+
+    The audio thread pushes one small record per block into a single-producer,
+    single-consumer FIFO and never waits: if the editor falls behind, records are
+    dropped. The editor drains the FIFO on its timer and folds the records into
+    windows of about a quarter second of audio, giving the average and peak load
+    per section, the voice count, steals and deadline overruns. */
+class DspLoadMeter
+{
+public:
+    static constexpr int numSections = FxChain::numStages + 2; // synth, each FX stage, master
+
+    static juce::String getSectionName(int section)
+    {
+        if (section == 0)
+            return "synth";
+        if (section <= FxChain::numStages)
+            return FxChain::getStageName(section - 1);
+        return "master";
+    }
+
+    /** One processBlock call. Ticks are juce::Time high-resolution ticks. */
+    struct Block
+    {
+        std::array<juce::int64, numSections> ticks {};
+        int numSamples { 0 };
+        int activeVoices { 0 };
+        int steals { 0 };
+    };
+
+    struct Summary
+    {
+        std::array<float, numSections> load {}; // average share of the real-time budget
+        float totalLoad { 0.0f };
+        float peakLoad { 0.0f };                 // the worst single block
+        int activeVoices { 0 };                  // the most seen in the window
+        int steals { 0 };                        // in the window
+        juce::int64 overruns { 0 };              // blocks over their deadline, ever
+
+        bool operator== (const Summary& other) const
+        {
+            return load == other.load && totalLoad == other.totalLoad && peakLoad == other.peakLoad
+                && activeVoices == other.activeVoices && steals == other.steals && overruns == other.overruns;
+        }
+
+        bool operator!= (const Summary& other) const { return !operator==(other); }
+    };
+
+    void prepare(double sampleRate)
+    {
+        ticksPerSample.store((double) juce::Time::getHighResolutionTicksPerSecond() / sampleRate);
+    }
+
+    /** Audio thread. */
+    void push(const Block& block) noexcept
+    {
+        juce::int64 total = 0;
+        for (auto t : block.ticks)
+            total += t;
+
+        if ((double) total > block.numSamples * ticksPerSample.load(std::memory_order_relaxed))
+            overruns.fetch_add(1, std::memory_order_relaxed);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 > 0)
+        {
+            blocks[(size_t) start1] = block;
+            fifo.finishedWrite(1);
+        }
+    }
+
+    /** Editor thread: drains what the audio thread produced and returns the summary
+        of the last complete window. */
+    const Summary& update()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            add(blocks[(size_t) (start1 + i)]);
+        for (int i = 0; i < size2; ++i)
+            add(blocks[(size_t) (start2 + i)]);
+
+        fifo.finishedRead(size1 + size2);
+        summary.overruns = overruns.load(std::memory_order_relaxed);
+        return summary;
+    }
+
+private:
+    static constexpr int capacity = 2048;
+    static constexpr double windowSeconds = 0.25;
+
+    juce::AbstractFifo fifo { capacity };
+    std::array<Block, capacity> blocks;
+    std::atomic<double> ticksPerSample { 1.0 };
+    std::atomic<juce::int64> overruns { 0 };
+
+    // Editor side: the window being filled, and the last complete one
+    std::array<double, numSections> windowTicks {};
+    double windowBudget { 0.0 };
+    float windowPeak { 0.0f };
+    int windowVoices { 0 };
+    int windowSteals { 0 };
+    Summary summary;
+
+    void add(const Block& block)
+    {
+        const double budget = block.numSamples * ticksPerSample.load(std::memory_order_relaxed);
+        if (budget <= 0.0)
+            return;
+
+        juce::int64 total = 0;
+        for (int s = 0; s < numSections; ++s)
+        {
+            windowTicks[(size_t) s] += (double) block.ticks[(size_t) s];
+            total += block.ticks[(size_t) s];
+        }
+
+        windowBudget += budget;
+        windowPeak = juce::jmax(windowPeak, (float) (total / budget));
+        windowVoices = juce::jmax(windowVoices, block.activeVoices);
+        windowSteals += block.steals;
+
+        if (windowBudget < windowSeconds * (double) juce::Time::getHighResolutionTicksPerSecond())
+            return;
+
+        summary.totalLoad = 0.0f;
+        for (int s = 0; s < numSections; ++s)
+        {
+            summary.load[(size_t) s] = (float) (windowTicks[(size_t) s] / windowBudget);
+            summary.totalLoad += summary.load[(size_t) s];
+        }
+
+        summary.peakLoad = windowPeak;
+        summary.activeVoices = windowVoices;
+        summary.steals = windowSteals;
+
+        windowTicks.fill(0.0);
+        windowBudget = 0.0;
+        windowPeak = 0.0f;
+        windowVoices = 0;
+        windowSteals = 0;
+    }
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "DspKernels.h"
+
+/** String-ensemble style chorus: 3-6 modulated taps per channel on one shared delay line.
+
+    The taps are computed as lanes of fixed-length eight-float arrays, so their LFOs,
+    delay times, read positions and interpolation weights are each one vector loop in
+    DspKernels; only the reads themselves are gathers. One master phase
+    drives every LFO, spread evenly across the taps, with the right channel's taps
+    falling halfway between the left's for width. Rate and depth follow the same
+    ranges as the classic chorus. */
+class EnsembleChorus
+{
+public:
+    static constexpr int minVoices = 3;
+    static constexpr int maxVoices = 6;
+
+    void prepare(double newSampleRate, int /*maxBlockSize*/)
+    {
+        sampleRate = newSampleRate;
+
+        const auto longest = (int) std::ceil((centreMs + spreadMs + maxDepthMs) * 0.001 * sampleRate) + 2;
+        int size = 1;
+        while (size < longest)
+            size <<= 1;
+
+        state.mask = size - 1;
+        for (size_t ch = 0; ch < lines.size(); ++ch)
+        {
+            lines[ch].assign((size_t) size, 0.0f);
+            state.lines[ch] = lines[ch].data();
+        }
+
+        state.msToSamples = (float) (0.001 * sampleRate);
+
+        depth.reset(sampleRate, 0.05);
+        wetLevel.reset(sampleRate, 0.05);
+        updateTaps();
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& line : lines)
+            std::fill(line.begin(), line.end(), 0.0f);
+
+        state.writeIndex = 0;
+        state.phase = 0.0f;
+    }
+
+    void setVoices(int newVoices)
+    {
+        newVoices = juce::jlimit(minVoices, maxVoices, newVoices);
+        if (newVoices != numVoices)
+        {
+            numVoices = newVoices;
+            updateTaps();
+        }
+    }
+
+    /** Rate in Hz, depth and mix 0..1. */
+    void setParameters(float rateHz, float newDepth, float mix)
+    {
+        state.phaseIncrement = (float) (rateHz / sampleRate);
+        depth.setTargetValue(newDepth);
+        wetLevel.setTargetValue(mix);
+    }
+
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        if (buffer.getNumChannels() < 2 || lines[0].empty())
+            return;
+
+        const int numSamples = buffer.getNumSamples();
+        auto* left = buffer.getWritePointer(0);
+        auto* right = buffer.getWritePointer(1);
+        const auto& kernels = DspKernels::get();
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int count = juce::jmin(chunkSize, numSamples - start);
+            for (int i = 0; i < count; ++i)
+            {
+                depthSamples[(size_t) i] = depth.getNextValue() * maxDepthMs * state.msToSamples;
+                wetGains[(size_t) i] = wetLevel.getNextValue();
+            }
+
+            kernels.ensembleChorus(state, left + start, right + start, depthSamples.data(), wetGains.data(), count);
+        }
+    }
+
+private:
+    static constexpr int lanes = DspKernels::ChorusState::lanes; // maxVoices rounded up; unused lanes have zero gain
+    static constexpr int chunkSize = 256;
+    static constexpr float centreMs = 12.0f;
+    static constexpr float spreadMs = 4.0f;
+    static constexpr float maxDepthMs = 6.0f;
+
+    double sampleRate { 44100.0 };
+    std::array<std::vector<float>, 2> lines;
+    DspKernels::ChorusState state;
+    std::array<float, chunkSize> depthSamples {};
+    std::array<float, chunkSize> wetGains {};
+
+    int numVoices { 4 };
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> depth { 0.5f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> wetLevel { 0.3f };
+
+    void updateTaps()
+    {
+        // Summed taps are mostly uncorrelated, so they add up in power
+        const float gain = 1.0f / std::sqrt((float) numVoices);
+
+        for (int k = 0; k < lanes; ++k)
+        {
+            const bool active = k < numVoices;
+            const float position = (float) k / (float) numVoices;
+
+            state.phaseOffsets[0][k] = position;
+            state.phaseOffsets[1][k] = position + 0.5f / (float) numVoices;
+            state.tapCentreMs[k] = centreMs + spreadMs * (active ? 2.0f * position - 1.0f : 0.0f);
+            state.tapGains[k] = active ? gain : 0.0f;
+        }
+    }
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "DspKernels.h"
+
+/** Eight-line feedback delay network reverb.
+
+    The lines share one interleaved power-of-two buffer, so a step writes all eight
+    lines with one contiguous store; damping, the Hadamard mix and the feedback gains
+    are fixed-length loops over eight floats, run by DspKernels at the CPU's widest
+    vector width.
+    Size sets the decay time (RT60), damping a one-pole lowpass in each loop.
+    Both are smoothed, and the per-line gains are only recomputed while they move. */
+class FdnReverb
+{
+public:
+    static constexpr int numLines = DspKernels::FdnState::numLines;
+
+    void prepare(double newSampleRate, int /*maxBlockSize*/)
+    {
+        sampleRate = newSampleRate;
+
+        // Mutually prime-ish lengths spread over 30-75 ms keep echo density high without ringing modes
+        static constexpr double lengthsMs[numLines] = { 29.7, 37.1, 41.1, 43.7, 53.9, 61.3, 67.1, 73.3 };
+
+        int longest = 0;
+        for (int k = 0; k < numLines; ++k)
+        {
+            state.lengths[k] = (int) std::round(lengthsMs[k] * 0.001 * sampleRate);
+            longest = juce::jmax(longest, state.lengths[k]);
+        }
+
+        int size = 1;
+        while (size <= longest)
+            size <<= 1;
+
+        state.mask = size - 1;
+        lines.assign((size_t) (size * numLines), 0.0f);
+        state.lines = lines.data();
+        state.inputGain = inputGain;
+        state.widthMain = widthMain;
+        state.widthCross = widthCross;
+
+        roomSize.reset(sampleRate, 0.1);
+        damping.reset(sampleRate, 0.1);
+        wetLevel.reset(sampleRate, 0.05);
+        updateCoefficients();
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(lines.begin(), lines.end(), 0.0f);
+        std::fill(std::begin(state.dampState), std::end(state.dampState), 0.0f);
+        state.writeIndex = 0;
+    }
+
+    void setParameters(float size, float damp, float mix)
+    {
+        roomSize.setTargetValue(size);
+        damping.setTargetValue(damp);
+        wetLevel.setTargetValue(mix);
+    }
+
+    /** Time for the loop to decay by 60 dB at the current size. */
+    double getDecaySeconds() const
+    {
+        return getDecaySecondsForSize(roomSize.getTargetValue());
+    }
+
+    /** 0.4 s at size 0, 2 s at 0.5, 10 s at 1. */
+    static double getDecaySecondsForSize(float size)
+    {
+        return 0.4 * std::pow(25.0, (double) size);
+    }
+
+    /** Adds the reverb to a stereo buffer (dry passes at unity, as before). */
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        if (buffer.getNumChannels() < 2 || lines.empty())
+            return;
+
+        const int numSamples = buffer.getNumSamples();
+
+        if (roomSize.isSmoothing() || damping.isSmoothing())
+        {
+            roomSize.skip(numSamples);
+            damping.skip(numSamples);
+            updateCoefficients();
+        }
+        else if (roomSize.getCurrentValue() != coefficientSize || damping.getCurrentValue() != coefficientDamp)
+        {
+            updateCoefficients();
+        }
+
+        auto* left = buffer.getWritePointer(0);
+        auto* right = buffer.getWritePointer(1);
+        const auto& kernels = DspKernels::get();
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int count = juce::jmin(chunkSize, numSamples - start);
+            for (int i = 0; i < count; ++i)
+                wetGains[(size_t) i] = wetLevel.getNextValue() * outputGain;
+
+            kernels.fdnReverb(state, left + start, right + start, wetGains.data(), count);
+        }
+    }
+
+private:
+    static constexpr float inputGain = 0.35f;
+    static constexpr float outputGain = 0.5f;
+    static constexpr float widthMain = 0.925f;  // width 0.85, as the previous reverb used
+    static constexpr float widthCross = 0.075f;
+
+    static constexpr int chunkSize = 256;
+
+    double sampleRate { 44100.0 };
+    std::vector<float> lines; // interleaved: sample n of line k at n * numLines + k
+    DspKernels::FdnState state;
+    std::array<float, chunkSize> wetGains {};
+
+    float coefficientSize { -1.0f };
+    float coefficientDamp { -1.0f };
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> roomSize { 0.5f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> damping { 0.35f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> wetLevel { 0.22f };
+
+    void updateCoefficients()
+    {
+        coefficientSize = roomSize.getCurrentValue();
+        coefficientDamp = damping.getCurrentValue();
+
+        const double rt60 = getDecaySecondsForSize(coefficientSize);
+        for (int k = 0; k < numLines; ++k)
+            state.gains[k] = (float) std::pow(10.0, -3.0 * state.lengths[k] / (rt60 * sampleRate));
+
+        state.dampCoeff = coefficientDamp * 0.85f;
+    }
+};
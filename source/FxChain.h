@@ -0,0 +1,85 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+
+/** User-facing FX slot order and per-slot enable flags.
+
+    Stored in the plugin state as a single string, e.g. "chorus delay !distortion reverb",
+    where a leading '!' marks a disabled slot. */
+struct FxChain
+{
+    enum Stage
+    {
+        chorus,
+        distortion,
+        delay,
+        reverb,
+        numStages
+    };
+
+    std::array<int, numStages> order { chorus, distortion, delay, reverb };
+    std::array<bool, numStages> enabled { true, true, true, true }; // indexed by Stage
+
+    static juce::String getStageName(int stage)
+    {
+        static const char* const names[numStages] = { "chorus", "distortion", "delay", "reverb" };
+        return stage >= 0 && stage < numStages ? names[stage] : "";
+    }
+
+    static int getStageForName(const juce::String& name)
+    {
+        for (int stage = 0; stage < numStages; ++stage)
+            if (name == getStageName(stage))
+                return stage;
+
+        return -1;
+    }
+
+    juce::String toString() const
+    {
+        juce::StringArray slots;
+        for (auto stage : order)
+            slots.add((enabled[(size_t) stage] ? "" : "!") + getStageName(stage));
+
+        return slots.joinIntoString(" ");
+    }
+
+    /** Parses toString() output; anything that isn't a full permutation of the
+        stages falls back to the default chain. */
+    static FxChain fromString(const juce::String& text)
+    {
+        FxChain chain;
+        std::array<bool, numStages> seen {};
+
+        auto slots = juce::StringArray::fromTokens(text, " ", "");
+        slots.removeEmptyStrings();
+        if (slots.size() != numStages)
+            return {};
+
+        for (int i = 0; i < numStages; ++i)
+        {
+            const bool isEnabled = !slots[i].startsWithChar('!');
+            const int stage = getStageForName(isEnabled ? slots[i] : slots[i].substring(1));
+            if (stage < 0 || seen[(size_t) stage])
+                return {};
+
+            seen[(size_t) stage] = true;
+            chain.order[(size_t) i] = stage;
+            chain.enabled[(size_t) stage] = isEnabled;
+        }
+
+        return chain;
+    }
+
+    /** Moves the slot at index one place earlier (negative) or later (positive). */
+    void moveSlot(int index, int direction)
+    {
+        const int other = index + (direction < 0 ? -1 : 1);
+        if (index >= 0 && index < numStages && other >= 0 && other < numStages)
+            std::swap(order[(size_t) index], order[(size_t) other]);
+    }
+
+    bool operator== (const FxChain& other) const { return order == other.order && enabled == other.enabled; }
+    bool operator!= (const FxChain& other) const { return !operator==(other); }
+};
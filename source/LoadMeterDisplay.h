@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "DspLoadMeter.h"
+
+/** Footer CPU meter: the real-time budget as a bar split by processing section,
+    with the window's peak block marked, and the voice, steal and overrun counts. */
+class LoadMeterDisplay : public juce::Component
+{
+public:
+    /** Repaints only when the summary differs, which is a few times a second. */
+    void setSummary(const DspLoadMeter::Summary& newSummary)
+    {
+        if (newSummary == summary)
+            return;
+
+        summary = newSummary;
+        repaint();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        // synth, chorus, distortion, delay, reverb, master
+        static const juce::Colour sectionColours[DspLoadMeter::numSections] = {
+            juce::Colour::fromString("0xff00d4ff"), juce::Colour::fromString("0xff00ff88"),
+            juce::Colour::fromString("0xffff5e3a"), juce::Colour::fromString("0xffd4af37"),
+            juce::Colour::fromString("0xffa070ff"), juce::Colour::fromRGB(180, 180, 190)
+        };
+
+        auto bounds = getLocalBounds().toFloat();
+        auto barRow = bounds.removeFromTop(bounds.getHeight() * 0.5f).reduced(0.0f, 3.0f);
+        auto label = barRow.removeFromRight(110.0f);
+        barRow.removeFromRight(6.0f);
+
+        g.setColour(juce::Colour::fromRGB(18, 18, 22).brighter(0.1f));
+        g.fillRoundedRectangle(barRow, 3.0f);
+
+        // Sections laid end to end; the bar is full at 100% of real time
+        float x = barRow.getX();
+        for (int s = 0; s < DspLoadMeter::numSections; ++s)
+        {
+            const float w = juce::jmin(barRow.getRight() - x, barRow.getWidth() * summary.load[(size_t) s]);
+            if (w <= 0.0f)
+                break;
+
+            g.setColour(sectionColours[s]);
+            g.fillRect(x, barRow.getY(), w, barRow.getHeight());
+            x += w;
+        }
+
+        const float peakX = barRow.getX() + barRow.getWidth() * juce::jmin(1.0f, summary.peakLoad);
+        g.setColour(summary.peakLoad >= 1.0f ? juce::Colours::red : juce::Colours::white.withAlpha(0.8f));
+        g.drawVerticalLine(juce::roundToInt(peakX), barRow.getY() - 2.0f, barRow.getBottom() + 2.0f);
+
+        g.setFont(juce::Font(10.0f).withExtraKerningFactor(0.05f));
+        g.setColour(juce::Colour::fromRGB(180, 180, 190));
+        g.drawText("CPU " + juce::String(summary.totalLoad * 100.0f, 1) + "%  PK " + juce::String(summary.peakLoad * 100.0f, 0) + "%",
+                   label, juce::Justification::centredRight, false);
+
+        g.setColour(summary.overruns > 0 ? juce::Colour::fromString("0xffff5e3a") : juce::Colour::fromRGB(180, 180, 190));
+        g.drawText("VOICES " + juce::String(summary.activeVoices) + "  |  STEALS " + juce::String(summary.steals)
+                       + "  |  OVERRUNS " + juce::String(summary.overruns),
+                   bounds, juce::Justification::centredRight, false);
+    }
+
+private:
+    DspLoadMeter::Summary summary;
+};
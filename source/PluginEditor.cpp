@@ -11,6 +11,11 @@ static const juce::Colour colourNeon = juce::Colour::fromString("0xff00ff88");
 static const juce::Colour colourText = juce::Colour::fromRGB(240, 240, 245);
 static const juce::Colour colourTextSecondary = juce::Colour::fromRGB(180, 180, 190);
 
+// Sample memory budgets offered in the footer, 0 = unlimited
+static constexpr std::array<juce::int64, 6> memoryBudgetsMb { 0, 256, 512, 1024, 2048, 4096 };
+
+static juce::Font getFooterFont() { return juce::Font(11.0f).withExtraKerningFactor(0.05f); }
+
 void RavelandAudioProcessorEditor::loadLogos()
 {
     // Load RaveLand logo from file - try multiple locations
@@ -253,20 +258,35 @@ RavelandAudioProcessorEditor::RavelandAudioProcessorEditor(RavelandAudioProcesso
     : AudioProcessorEditor(&p), processor(p)
 {
     loadLogos();
-    startTimerHz(60); // 60fps for smooth animations
+    startTimerHz(60); // polls the processor; only what changed repaints
 
     auto& vts = processor.getValueTreeState();
 
-    // Create waveform displays
+    // Create waveform displays, each showing its tap of the audio
     for (int i = 0; i < 3; ++i)
     {
+        // Oscillators the voices don't run yet have nothing to show, so stay hidden
         oscWaveforms[i] = std::make_unique<WaveformDisplay>();
-        addAndMakeVisible(oscWaveforms[i].get());
+        if (i < RavelandAudioProcessor::numScopedOscillators)
+        {
+            oscWaveforms[i]->setSource(&processor.getOscillatorScope(i));
+            addAndMakeVisible(oscWaveforms[i].get());
+        }
+        else
+        {
+            addChildComponent(oscWaveforms[i].get());
+        }
         
         layerWaveforms[i] = std::make_unique<WaveformDisplay>();
+        layerWaveforms[i]->setSource(&processor.getLayerScope(i));
+        layerWaveforms[i]->setTraceColour(waveformNeon);
         addAndMakeVisible(layerWaveforms[i].get());
     }
 
+    masterWaveform.setSource(&processor.getMasterScope());
+    masterWaveform.setTraceColour(waveformGold);
+    addAndMakeVisible(masterWaveform);
+
     // Preset browser
     presetCombo.addItemList(processor.getPresetNames(), 1);
     presetCombo.setSelectedId(processor.getCurrentPresetIndex() + 1);
@@ -286,6 +306,12 @@ RavelandAudioProcessorEditor::RavelandAudioProcessorEditor(RavelandAudioProcesso
     addAndMakeVisible(masterGainLabel);
     masterGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(vts, "masterGain", masterGainSlider);
 
+    setupToggle(limiterButton);
+    limiterButton.setButtonText("TRUE-PEAK LIMITER");
+    limiterButton.setTooltip("Holds the output under the ceiling; adds a few samples of latency");
+    addAndMakeVisible(limiterButton);
+    limiterAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(vts, "limiterEnabled", limiterButton);
+
     // Oscillators
     for (int i = 0; i < 3; ++i)
     {
@@ -450,6 +476,19 @@ RavelandAudioProcessorEditor::RavelandAudioProcessorEditor(RavelandAudioProcesso
     distDriveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(vts, "distDrive", distDriveSlider);
     distToneAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(vts, "distTone", distToneSlider);
 
+    // Convolution reverb
+    setupToggle(reverbConvolutionButton);
+    reverbConvolutionButton.setButtonText("CONVOLUTION");
+    addAndMakeVisible(reverbConvolutionButton);
+    reverbModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(vts, "reverbMode", reverbConvolutionButton);
+
+    reverbImpulseButton.setTooltip("Load an impulse response for the convolution reverb");
+    reverbImpulseButton.setColour(juce::TextButton::buttonColourId, colourSurface);
+    reverbImpulseButton.setColour(juce::TextButton::textColourOffId, colourAccent);
+    reverbImpulseButton.onClick = [this] { chooseReverbImpulse(); };
+    addAndMakeVisible(reverbImpulseButton);
+    refreshReverbImpulseButton();
+
     // Mono/Legato
     setupToggle(monoButton);
     monoButton.setButtonText("Mono");
@@ -488,6 +527,10 @@ RavelandAudioProcessorEditor::RavelandAudioProcessorEditor(RavelandAudioProcesso
     oscWaveformLabel3.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(oscWaveformLabel3);
 
+    // Each label shows only with its display
+    oscWaveformLabel2.setVisible(oscWaveforms[1]->isVisible());
+    oscWaveformLabel3.setVisible(oscWaveforms[2]->isVisible());
+
     layerWaveformLabel1.setText("SAMPLE LAYER", juce::dontSendNotification);
     layerWaveformLabel1.setFont(juce::Font(8.0f, juce::Font::bold));
     layerWaveformLabel1.setColour(juce::Label::textColourId, colourTextSecondary);
@@ -506,14 +549,183 @@ RavelandAudioProcessorEditor::RavelandAudioProcessorEditor(RavelandAudioProcesso
     layerWaveformLabel3.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(layerWaveformLabel3);
 
+    // FX chain order
+    for (int i = 0; i < FxChain::numStages; ++i)
+    {
+        auto& button = fxSlotButtons[(size_t) i];
+        button.setColour(juce::TextButton::buttonColourId, colourSurface.brighter(0.1f));
+        button.setColour(juce::TextButton::buttonOnColourId, colourGold.withAlpha(0.35f));
+        button.setColour(juce::TextButton::textColourOffId, colourTextSecondary);
+        button.setColour(juce::TextButton::textColourOnId, colourText);
+        button.onClick = [this, i]
+        {
+            auto chain = processor.getFxChain();
+            const auto stage = (size_t) chain.order[(size_t) i];
+            chain.enabled[stage] = !chain.enabled[stage];
+            processor.setFxChain(chain);
+            refreshFxChainButtons();
+        };
+        addAndMakeVisible(button);
+    }
+
+    for (int i = 0; i < FxChain::numStages - 1; ++i)
+    {
+        auto& button = fxSwapButtons[(size_t) i];
+        button.setButtonText("<>");
+        button.setTooltip("Swap these two FX slots");
+        button.setColour(juce::TextButton::buttonColourId, colourSurface);
+        button.setColour(juce::TextButton::textColourOffId, colourAccent);
+        button.onClick = [this, i]
+        {
+            auto chain = processor.getFxChain();
+            chain.moveSlot(i, 1);
+            processor.setFxChain(chain);
+            refreshFxChainButtons();
+        };
+        addAndMakeVisible(button);
+    }
+
+    refreshFxChainButtons();
+
+    addAndMakeVisible(loadMeterDisplay);
+
+    setupToggle(preconvertButton);
+    preconvertButton.setButtonText("PRE-CONVERT");
+    preconvertButton.setTooltip("Resample sample stacks to the session rate once, cached on disk");
+    preconvertButton.setToggleState(processor.isSamplePreconversionEnabled(), juce::dontSendNotification);
+    preconvertButton.onClick = [this] { processor.setSamplePreconversion(preconvertButton.getToggleState()); };
+    addAndMakeVisible(preconvertButton);
+
+    // Item id i + 1 selects memoryBudgetsMb[i]
+    for (size_t i = 0; i < memoryBudgetsMb.size(); ++i)
+        memoryBudgetBox.addItem(memoryBudgetsMb[i] == 0 ? juce::String("NO LIMIT")
+                                                        : juce::File::descriptionOfSizeInBytes(memoryBudgetsMb[i] << 20).toUpperCase(),
+                                (int) i + 1);
+    memoryBudgetBox.setTooltip("Sample memory budget: least recently played zones are evicted above it");
+    memoryBudgetBox.setColour(juce::ComboBox::backgroundColourId, juce::Colour::fromFloatRGBA(0.1f, 0.1f, 0.12f, 0.95f));
+    memoryBudgetBox.setColour(juce::ComboBox::textColourId, colourTextSecondary);
+    memoryBudgetBox.setColour(juce::ComboBox::outlineColourId, colourAccent.withAlpha(0.5f));
+    memoryBudgetBox.setColour(juce::ComboBox::arrowColourId, colourAccent);
+    memoryBudgetBox.onChange = [this]
+    {
+        const int index = memoryBudgetBox.getSelectedId() - 1;
+        if (index >= 0)
+            processor.setSampleMemoryBudget(memoryBudgetsMb[(size_t) index] << 20);
+    };
+    addAndMakeVisible(memoryBudgetBox);
+    refreshMemoryBudgetBox();
+
     // Set default size last so `resized()` can safely layout child components.
     setResizable(true, true);
     setResizeLimits(1000, 750, 1920, 1080);
     setSize(1200, 750);
 }
 
+void RavelandAudioProcessorEditor::timerCallback()
+{
+    // Presets and host state restores can change the chain behind the editor's back
+    if (processor.getFxChain() != shownFxChain)
+        refreshFxChainButtons();
+
+    // Presets and state restores can swap the impulse response too
+    if (processor.getReverbImpulseFile() != shownImpulse)
+        refreshReverbImpulseButton();
+
+    if (processor.isSamplePreconversionEnabled() != preconvertButton.getToggleState())
+        preconvertButton.setToggleState(processor.isSamplePreconversionEnabled(), juce::dontSendNotification);
+
+    if (processor.getSamplePoolStats().budgetBytes != shownMemoryBudget)
+        refreshMemoryBudgetBox();
+
+    // Drained every tick so the FIFO never fills; the summary changes a few times a second
+    loadMeterDisplay.setSummary(processor.getLoadMeter().update());
+
+    // The scopes repaint themselves when audio arrives; nothing here repaints the whole editor
+    refreshPoolStats();
+}
+
+void RavelandAudioProcessorEditor::refreshPoolStats()
+{
+    // Sample memory: resident vs budget, evictions and reload latency
+    const auto poolStats = processor.getSamplePoolStats();
+    juce::String text = "SAMPLES " + juce::File::descriptionOfSizeInBytes(poolStats.residentBytes);
+    if (poolStats.budgetBytes > 0)
+        text << " / " << juce::File::descriptionOfSizeInBytes(poolStats.budgetBytes)
+             << "  |  EVICTED " << poolStats.evictions
+             << "  |  RELOAD " << juce::String(poolStats.lastReloadMs, 1) << " MS";
+
+    if (text == poolStatsText)
+        return;
+
+    // Right-aligned, so the old and new text both end at the right edge
+    const auto font = getFooterFont();
+    const auto width = (int) std::ceil(juce::jmax(font.getStringWidthFloat(text), font.getStringWidthFloat(poolStatsText))) + 2;
+    poolStatsText = text;
+    repaint(poolStatsArea.withLeft(juce::jmax(poolStatsArea.getX(), poolStatsArea.getRight() - width)));
+}
+
+void RavelandAudioProcessorEditor::refreshFxChainButtons()
+{
+    shownFxChain = processor.getFxChain();
+
+    for (int i = 0; i < FxChain::numStages; ++i)
+    {
+        const auto stage = shownFxChain.order[(size_t) i];
+        fxSlotButtons[(size_t) i].setButtonText(FxChain::getStageName(stage).toUpperCase());
+        fxSlotButtons[(size_t) i].setToggleState(shownFxChain.enabled[(size_t) stage], juce::dontSendNotification);
+    }
+}
+
+void RavelandAudioProcessorEditor::chooseReverbImpulse()
+{
+    impulseChooser = std::make_unique<juce::FileChooser>("Load an impulse response", shownImpulse,
+                                                         "*.wav;*.aif;*.aiff;*.flac");
+
+    impulseChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                [this](const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        if (!file.existsAsFile())
+            return;
+
+        processor.loadReverbImpulse(file);
+
+        // Loading an IR means wanting to hear it
+        if (auto* mode = processor.getValueTreeState().getParameter("reverbMode"))
+            mode->setValueNotifyingHost(1.0f);
+
+        refreshReverbImpulseButton();
+    });
+}
+
+void RavelandAudioProcessorEditor::refreshReverbImpulseButton()
+{
+    shownImpulse = processor.getReverbImpulseFile();
+    reverbImpulseButton.setButtonText(shownImpulse == juce::File() ? "LOAD IR"
+                                                                   : shownImpulse.getFileNameWithoutExtension().toUpperCase());
+}
+
+void RavelandAudioProcessorEditor::refreshMemoryBudgetBox()
+{
+    shownMemoryBudget = processor.getSamplePoolStats().budgetBytes;
+
+    for (size_t i = 0; i < memoryBudgetsMb.size(); ++i)
+    {
+        if ((memoryBudgetsMb[i] << 20) == shownMemoryBudget)
+        {
+            memoryBudgetBox.setSelectedId((int) i + 1, juce::dontSendNotification);
+            return;
+        }
+    }
+
+    // Budgets set outside the editor needn't be one of the presets
+    memoryBudgetBox.setText(juce::File::descriptionOfSizeInBytes(shownMemoryBudget).toUpperCase(), juce::dontSendNotification);
+}
+
 void RavelandAudioProcessorEditor::paint(juce::Graphics& g)
 {
+    RAVELAND_TRACE_SCOPE("editor paint");
+
     // Set window icon on first paint (when peer is available)
     static bool iconSet = false;
     if (!iconSet && getPeer() != nullptr)
@@ -658,8 +870,9 @@ void RavelandAudioProcessorEditor::paint(juce::Graphics& g)
 
     // Modern footer text
     g.setColour(colourTextSecondary);
-    g.setFont(juce::Font(11.0f).withExtraKerningFactor(0.05f));
+    g.setFont(getFooterFont());
     g.drawText("PERFORMANCE CONTROLS", footer.reduced(16, 8), juce::Justification::centredLeft, false);
+    g.drawText(poolStatsText, poolStatsArea.toFloat(), juce::Justification::centredRight, false);
     
     // Update animation phase with faster speed for flashier effects
     glowPhase += 0.035f;
@@ -672,6 +885,9 @@ void RavelandAudioProcessorEditor::resized()
     auto bounds = getLocalBounds().toFloat();
     bounds.reduce(24, 24); // Main margin
 
+    // Where paint() draws the sample memory readout, inside its footer
+    poolStatsArea = bounds.withTop(bounds.getBottom() - 80.0f).reduced(24, 16).reduced(16, 8).toNearestInt();
+
     // Header section (increased height for better spacing)
     auto header = bounds.removeFromTop(140.0f);
 
@@ -752,9 +968,13 @@ void RavelandAudioProcessorEditor::layoutFXSection(juce::Rectangle<float> area)
     // Four FX sections with equal spacing
     const float fxHeight = (area.getHeight() - 30) / 4.0f; // Account for spacing
 
-    // Reverb
-    layoutFXBlock(area, 0, fxHeight, {&reverbMixSlider, &reverbSizeSlider, &reverbDampSlider},
+    // Reverb, with the convolution mode and impulse loader under its knobs
+    auto reverbArea = area.removeFromTop(fxHeight + 8);
+    auto reverbControls = reverbArea.removeFromBottom(32).removeFromTop(24).reduced(8, 0);
+    layoutFXBlock(reverbArea, 0, fxHeight - 24, {&reverbMixSlider, &reverbSizeSlider, &reverbDampSlider},
                   {&reverbMixLabel, &reverbSizeLabel, &reverbDampLabel});
+    reverbConvolutionButton.setBounds(reverbControls.removeFromLeft(reverbControls.getWidth() * 0.5f).toNearestInt());
+    reverbImpulseButton.setBounds(reverbControls.reduced(4, 0).toNearestInt());
 
     // Delay
     layoutFXBlock(area, 1, fxHeight, {&delayMixSlider, &delayTimeSlider, &delayFeedbackSlider},
@@ -837,6 +1057,9 @@ void RavelandAudioProcessorEditor::layoutOscillatorSection(juce::Rectangle<float
 
     // Master section at bottom
     auto masterArea = area.removeFromBottom(100).reduced(8, 8);
+    auto masterScopeArea = masterArea.removeFromRight(masterArea.getWidth() * 0.55f);
+    limiterButton.setBounds(masterScopeArea.removeFromTop(20).toNearestInt());
+    masterWaveform.setBounds(masterScopeArea.toNearestInt());
     masterGainSlider.setBounds(masterArea.withTrimmedTop(20).toNearestInt());
     masterGainLabel.setBounds(masterArea.withHeight(16).toNearestInt());
 }
@@ -848,13 +1071,32 @@ void RavelandAudioProcessorEditor::layoutFooterSection(juce::Rectangle<float> bo
     // Performance controls
     auto controlsArea = footer.reduced(8, 8);
 
-    monoButton.setBounds(controlsArea.removeFromLeft(120).toNearestInt());
+    monoButton.setBounds(controlsArea.removeFromLeft(100).toNearestInt());
     controlsArea.removeFromLeft(20);
 
-    legatoButton.setBounds(controlsArea.removeFromLeft(120).toNearestInt());
-    controlsArea.removeFromLeft(40);
+    legatoButton.setBounds(controlsArea.removeFromLeft(100).toNearestInt());
+    controlsArea.removeFromLeft(20);
 
     auto portamentoArea = controlsArea.removeFromLeft(180);
     portamentoSlider.setBounds(portamentoArea.withTrimmedTop(20).toNearestInt());
     portamentoLabel.setBounds(portamentoArea.withHeight(16).toNearestInt());
+    controlsArea.removeFromLeft(20);
+
+    // FX chain strip
+    auto chainArea = controlsArea.removeFromLeft(300).withSizeKeepingCentre(300, 26);
+    for (int i = 0; i < FxChain::numStages; ++i)
+    {
+        fxSlotButtons[(size_t) i].setBounds(chainArea.removeFromLeft(60).toNearestInt());
+        if (i < FxChain::numStages - 1)
+            fxSwapButtons[(size_t) i].setBounds(chainArea.removeFromLeft(20).reduced(2, 4).toNearestInt());
+    }
+
+    // DSP load meter, above the sample memory readout
+    loadMeterDisplay.setBounds(controlsArea.removeFromRight(260).removeFromTop(34).toNearestInt());
+    controlsArea.removeFromRight(6);
+
+    // Sample memory settings, beside the readout
+    auto memoryArea = controlsArea.removeFromRight(124);
+    preconvertButton.setBounds(memoryArea.removeFromTop(26).toNearestInt());
+    memoryBudgetBox.setBounds(memoryArea.removeFromTop(24).reduced(0, 1).toNearestInt());
 }
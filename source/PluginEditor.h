@@ -3,6 +3,8 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "WaveformDisplay.h"
 #include "FancyKnob.h"
+#include "FxChain.h"
+#include "LoadMeterDisplay.h"
 
 class RavelandAudioProcessor;
 
@@ -15,7 +17,7 @@ public:
 
     void paint(juce::Graphics&) override;
     void resized() override;
-    void timerCallback() override { repaint(); }
+    void timerCallback() override;
 
 private:
     RavelandAudioProcessor& processor;
@@ -30,6 +32,7 @@ private:
     // Waveform displays
     std::array<std::unique_ptr<WaveformDisplay>, 3> oscWaveforms;
     std::array<std::unique_ptr<WaveformDisplay>, 3> layerWaveforms;
+    WaveformDisplay masterWaveform;
     juce::Label oscWaveformLabel1, oscWaveformLabel2, oscWaveformLabel3;
     juce::Label layerWaveformLabel1, layerWaveformLabel2, layerWaveformLabel3;
 
@@ -41,6 +44,8 @@ private:
     FancyKnob masterGainSlider;
     juce::Label masterGainLabel;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> masterGainAttachment;
+    juce::ToggleButton limiterButton;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> limiterAttachment;
 
     // Oscillators (3)
     struct OscControls
@@ -87,6 +92,13 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> distDriveAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> distToneAttachment;
 
+    // Convolution reverb: mode switch and impulse response loader
+    juce::ToggleButton reverbConvolutionButton;
+    juce::TextButton reverbImpulseButton;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> reverbModeAttachment;
+    std::unique_ptr<juce::FileChooser> impulseChooser;
+    juce::File shownImpulse;
+
     // Mono/Legato
     juce::ToggleButton monoButton, legatoButton;
     FancyKnob portamentoSlider;
@@ -95,11 +107,33 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> legatoAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> portamentoAttachment;
 
+    // FX chain: one button per slot in processing order (click to bypass),
+    // and a swap button between each neighbouring pair
+    std::array<juce::TextButton, FxChain::numStages> fxSlotButtons;
+    std::array<juce::TextButton, FxChain::numStages - 1> fxSwapButtons;
+    FxChain shownFxChain;
+
+    LoadMeterDisplay loadMeterDisplay;
+
+    // Sample memory readout drawn in the footer, repainted only when its text changes
+    juce::String poolStatsText;
+    juce::Rectangle<int> poolStatsArea;
+
+    // Sample memory settings, saved with the state rather than as parameters
+    juce::ToggleButton preconvertButton;
+    juce::ComboBox memoryBudgetBox;
+    juce::int64 shownMemoryBudget { -1 };
+
     void setupToggle(juce::ToggleButton& button);
     void loadLogos();
     void drawNeonGlow(juce::Graphics& g, juce::Rectangle<float> bounds);
     void drawPanelWithGlow(juce::Graphics& g, juce::Rectangle<float> bounds, const juce::String& title);
     void drawRaveLandLogo(juce::Graphics& g, juce::Rectangle<float> bounds);
+    void refreshFxChainButtons();
+    void chooseReverbImpulse();
+    void refreshReverbImpulseButton();
+    void refreshMemoryBudgetBox();
+    void refreshPoolStats();
 
     // Layout functions
     void layoutLayerSection(juce::Rectangle<float> area);
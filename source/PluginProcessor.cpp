@@ -41,24 +41,40 @@ namespace
                                                                      juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("reverbDamp", "Reverb Damp",
                                                                      juce::NormalisableRange<float>(0.0f, 1.0f), 0.35f));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>("reverbMode", "Reverb Mode",
+                                                                      juce::StringArray { "Algorithmic", "Convolution" }, 0));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("delayMix", "Delay Mix",
                                                                      juce::NormalisableRange<float>(0.0f, 1.0f), 0.18f));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("delayTime", "Delay Time",
                                                                      juce::NormalisableRange<float>(1.0f, 800.0f), 250.0f));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("delayFeedback", "Delay Feedback",
                                                                      juce::NormalisableRange<float>(0.0f, 0.95f), 0.3f));
+        params.push_back(std::make_unique<juce::AudioParameterBool>("delaySync", "Delay Sync", false));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>("delaySyncDiv", "Delay Sync Division",
+                                                                      StereoDelay::getSyncDivisionNames(), 8));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("chorusMix", "Chorus Mix",
                                                                      juce::NormalisableRange<float>(0.0f, 1.0f), 0.30f));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("chorusRate", "Chorus Rate",
                                                                      juce::NormalisableRange<float>(0.05f, 10.0f), 1.5f));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("chorusDepth", "Chorus Depth",
                                                                      juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>("chorusMode", "Chorus Mode",
+                                                                      juce::StringArray { "Classic", "Ensemble" }, 0));
+        params.push_back(std::make_unique<juce::AudioParameterInt>("chorusVoices", "Chorus Voices",
+                                                                   EnsembleChorus::minVoices, EnsembleChorus::maxVoices, 4));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("distMix", "Distortion Mix",
                                                                      juce::NormalisableRange<float>(0.0f, 1.0f), 0.26f));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("distDrive", "Distortion Drive",
                                                                      juce::NormalisableRange<float>(0.0f, 1.0f), 0.4f));
         params.push_back(std::make_unique<juce::AudioParameterFloat>("distTone", "Distortion Tone",
                                                                      juce::NormalisableRange<float>(-1.0f, 1.0f), 0.0f));
+        params.push_back(std::make_unique<juce::AudioParameterChoice>("distOversampling", "Distortion Oversampling",
+                                                                      DistortionStage::getOversamplingNames(), 0));
+
+        // Master
+        params.push_back(std::make_unique<juce::AudioParameterBool>("limiterEnabled", "Limiter Enabled", false));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("limiterCeiling", "Limiter Ceiling",
+                                                                     juce::NormalisableRange<float>(-12.0f, 0.0f), -1.0f));
 
         // Mono/Legato
         params.push_back(std::make_unique<juce::AudioParameterBool>("monoEnabled", "Mono Enabled", false));
@@ -74,20 +90,53 @@ RavelandAudioProcessor::RavelandAudioProcessor()
     : AudioProcessor(BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true)),
       parameters(*this, nullptr, "PARAMS", createParameterLayout())
 {
+    // Pick the DSP kernels now, rather than on the first audio callback
+    juce::ignoreUnused(DspKernels::get());
+
     struct SimpleSound : public juce::SynthesiserSound
     {
         bool appliesToNote (int) override      { return true; }
         bool appliesToChannel (int) override   { return true; }
     };
 
+    for (int i = 0; i < 3; ++i)
+    {
+        auto prefix = "layer" + juce::String(i + 1);
+        layerEnabledParams[(size_t) i] = parameters.getRawParameterValue(prefix + "Enabled");
+        layerGainParams[(size_t) i] = parameters.getRawParameterValue(prefix + "Gain");
+        layerStartRandParams[(size_t) i] = parameters.getRawParameterValue(prefix + "StartRand");
+    }
+
     constexpr int numVoices = 16;
     for (int i = 0; i < numVoices; ++i)
-        synth.addVoice(new RavelandVoice());
+    {
+        auto* voice = new RavelandVoice();
+        voice->setSampleLayers(&sampleLayers, &layerEnabled, &layerGain, &layerStartRand);
+        voice->setScopeBuses(&scopeBuses);
+        synth.addVoice(voice);
+        voices.add(voice);
+    }
 
     synth.addSound(new SimpleSound());
 
     createFactoryPresets();
     loadPreset(0);
+
+    setFxChain(FxChain());
+
+    // RAVELAND_TRACE=<file.json> records a timeline of this session, written on exit
+    const auto tracePath = juce::SystemStats::getEnvironmentVariable("RAVELAND_TRACE", {});
+    if (tracePath.isNotEmpty() && !TraceRecorder::getInstance().isActive())
+    {
+        traceOutput = juce::File::getCurrentWorkingDirectory().getChildFile(tracePath);
+        TraceRecorder::getInstance().start();
+    }
+}
+
+RavelandAudioProcessor::~RavelandAudioProcessor()
+{
+    if (traceOutput != juce::File())
+        TraceRecorder::getInstance().stop(traceOutput);
 }
 
 void RavelandAudioProcessor::createFactoryPresets()
@@ -153,6 +202,7 @@ void RavelandAudioProcessor::loadPreset(int index)
         *parameters.getRawParameterValue("reverbMix") = 0.22f;
         *parameters.getRawParameterValue("delayMix") = 0.18f;
         *parameters.getRawParameterValue("chorusMix") = 0.30f;
+        *parameters.getRawParameterValue("chorusMode") = 0.0f;
     }
     else if (index == 1) // Rave
     {
@@ -172,6 +222,8 @@ void RavelandAudioProcessor::loadPreset(int index)
         *parameters.getRawParameterValue("reverbMix") = 0.28f;
         *parameters.getRawParameterValue("delayMix") = 0.26f;
         *parameters.getRawParameterValue("chorusMix") = 0.55f;
+        *parameters.getRawParameterValue("chorusMode") = 1.0f;
+        *parameters.getRawParameterValue("chorusVoices") = 6.0f;
     }
     else if (index == 2) // Trance
     {
@@ -188,6 +240,7 @@ void RavelandAudioProcessor::loadPreset(int index)
         *parameters.getRawParameterValue("reverbMix") = 0.14f;
         *parameters.getRawParameterValue("delayMix") = 0.18f;
         *parameters.getRawParameterValue("chorusMix") = 0.25f;
+        *parameters.getRawParameterValue("chorusMode") = 0.0f;
         *parameters.getRawParameterValue("monoEnabled") = 1.0f;
         *parameters.getRawParameterValue("legatoEnabled") = 1.0f;
         *parameters.getRawParameterValue("portamento") = 0.55f;
@@ -207,6 +260,7 @@ void RavelandAudioProcessor::loadPreset(int index)
         *parameters.getRawParameterValue("reverbMix") = 0.20f;
         *parameters.getRawParameterValue("delayMix") = 0.15f;
         *parameters.getRawParameterValue("chorusMix") = 0.40f;
+        *parameters.getRawParameterValue("chorusMode") = 0.0f;
         *parameters.getRawParameterValue("distMix") = 0.35f;
     }
 }
@@ -224,17 +278,49 @@ void RavelandAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
             v->prepare(spec);
 
     chorus.prepare(spec);
-    delay.prepare(spec);
-    distortion.prepare(spec);
+    ensembleChorus.prepare(sampleRate, samplesPerBlock);
+
+    distortion.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+    distortion.setOversamplingIndex((int) parameters.getRawParameterValue("distOversampling")->load());
+    distortionLatency.store(distortion.getLatencySamples());
+
+    delay.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+    delay.setDelayTimeMs(parameters.getRawParameterValue("delayTime")->load());
+    delay.reset();
+
+    reverb.prepare(sampleRate, samplesPerBlock);
+    convolutionReverb.prepare(sampleRate, samplesPerBlock);
+
+    limiter.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+    loadMeter.prepare(sampleRate);
+
+    scopeBusBuffer.setSize((int) scopeBuses.size(), samplesPerBlock);
+    for (auto* scope : { &oscillatorScopes[0], &oscillatorScopes[1], &oscillatorScopes[2],
+                         &layerScopes[0], &layerScopes[1], &layerScopes[2], &masterScope })
+        scope->prepare(sampleRate);
+
+    limiterActive = parameters.getRawParameterValue("limiterEnabled")->load() > 0.5f;
+    updateLatency();
+
+    // Stacks pre-converted for another rate are reloaded on the message thread
+    if (isSamplePreconversionEnabled())
+        triggerAsyncUpdate();
+}
+
+void RavelandAudioProcessor::updateLatency()
+{
+    const auto* plan = fxPlan.load();
+    const bool limiterOn = parameters.getRawParameterValue("limiterEnabled")->load() > 0.5f;
+
+    setLatencySamples((plan != nullptr && plan->contains(FxChain::distortion) ? distortionLatency.load() : 0)
+                      + (limiterOn ? limiter.getLatencySamples() : 0));
+}
 
-    juce::Reverb::Parameters params;
-    params.roomSize = 0.5f;
-    params.damping = 0.35f;
-    params.wetLevel = 0.22f;
-    params.dryLevel = 1.0f;
-    params.width = 0.85f;
-    reverb.setSampleRate(sampleRate);
-    reverb.setParameters(params);
+void RavelandAudioProcessor::postLatencyChange()
+{
+    // Hosts expect latency changes on the message thread
+    latencyChanged.store(true);
+    triggerAsyncUpdate();
 }
 
 void RavelandAudioProcessor::releaseResources()
@@ -252,76 +338,438 @@ bool RavelandAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
 void RavelandAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
 {
     juce::ScopedNoDenormals noDenormals;
+    RAVELAND_TRACE_SCOPE("processBlock");
 
     buffer.clear();
 
-    // Render synth oscillators
-    synth.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+    // Section timing, always on: one clock read per section. It feeds the editor's meter
+    // and, when enabled, the offline tools' totals.
+    DspLoadMeter::Block stats;
+    stats.numSamples = buffer.getNumSamples();
+
+    auto lapStart = juce::Time::getHighResolutionTicks();
+    const auto lap = [&stats, &lapStart](int section)
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        stats.ticks[(size_t) section] += now - lapStart;
+        lapStart = now;
+    };
 
-    // TODO: Add sample layer rendering here when samples are loaded
-    // For now, sample layers are architecture-ready but not yet rendering
+    const auto* plan = fxPlan.load(std::memory_order_acquire);
+    if (plan != lastFxPlan)
+    {
+        // Stages dropped from the chain sleep, and start clean if re-enabled
+        for (int stage = 0; stage < FxChain::numStages; ++stage)
+            if (!plan->contains(stage))
+                stageActivity[(size_t) stage].disable();
 
-    // FX
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
+        lastFxPlan = plan;
+    }
 
-    // Chorus
-    chorus.setMix(parameters.getRawParameterValue("chorusMix")->load());
-    chorus.setRate(parameters.getRawParameterValue("chorusRate")->load());
-    chorus.setDepth(parameters.getRawParameterValue("chorusDepth")->load());
-    chorus.process(context);
+    // Nothing playing, nothing ringing, nothing arriving: idle instances stop here
+    if (midi.isEmpty() && !isAnyVoiceActive() && !isAnyStageAwake(*plan))
+    {
+        pushScopeSilence(buffer.getNumSamples());
+        finishBlock(stats);
+        return;
+    }
 
-    // Delay + Distortion
-    const auto delayMix = parameters.getRawParameterValue("delayMix")->load();
-    const auto delayTime = parameters.getRawParameterValue("delayTime")->load();
-    const auto delayFeedback = parameters.getRawParameterValue("delayFeedback")->load();
-    const auto distMix = parameters.getRawParameterValue("distMix")->load();
-    const auto distDrive = parameters.getRawParameterValue("distDrive")->load();
-    const auto distTone = parameters.getRawParameterValue("distTone")->load();
+    for (size_t i = 0; i < sampleLayers.size(); ++i)
+    {
+        layerEnabled[i] = layerEnabledParams[i]->load() > 0.5f;
+        layerGain[i] = layerGainParams[i]->load();
+        layerStartRand[i] = (int) layerStartRandParams[i]->load();
+    }
 
-    // Calculate delay in samples (simplified - using fixed delay for now)
-    const int delaySamples = static_cast<int>(spec.sampleRate * delayTime / 1000.0f);
-    const int maxDelaySamples = 44100; // 1 second at 44.1kHz
-    const int clampedDelaySamples = juce::jlimit(1, maxDelaySamples, delaySamples);
+    // Scope buses for the sources a display is watching
+    const int numSamples = buffer.getNumSamples();
+    const bool scopesFit = numSamples <= scopeBusBuffer.getNumSamples();
+    for (int bus = 0; bus < (int) scopeBuses.size(); ++bus)
+    {
+        auto*& samples = scopeBuses[(size_t) bus];
+        samples = scopesFit && getScopeForBus(bus).isActive() ? scopeBusBuffer.getWritePointer(bus) : nullptr;
+        if (samples != nullptr)
+            juce::FloatVectorOperations::clear(samples, numSamples);
+    }
 
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    // Render synth oscillators and sample layers
     {
-        auto* data = buffer.getWritePointer(channel);
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
-        {
-            // Simple delay implementation using the DelayLine
-            auto delayed = delay.popSample(channel, clampedDelaySamples) * delayFeedback;
-            delay.pushSample(channel, data[i] + delayed);
-
-            // Apply distortion with drive and tone
-            auto distInput = delayed * (1.0f + distDrive * 4.0f);
-            auto dist = distortion.processSample(distInput);
-            // Simple tone control (high shelf)
-            dist = dist * (1.0f + distTone * 0.5f) + dist * distTone * 0.3f;
-
-            auto wet = data[i] * (1.0f - distMix) + dist * distMix;
-            data[i] = data[i] * (1.0f - delayMix) + wet * delayMix;
-        }
+        RAVELAND_TRACE_SCOPE("synth");
+        const juce::SpinLock::ScopedLockType sl(layerLock);
+        synth.renderNextBlock(buffer, midi, 0, numSamples);
     }
 
-    // Reverb
-    if (buffer.getNumChannels() >= 2)
+    for (int bus = 0; bus < (int) scopeBuses.size(); ++bus)
+        if (auto* samples = scopeBuses[(size_t) bus])
+            getScopeForBus(bus).push(samples, nullptr, numSamples);
+
+    if (auto* playHead = getPlayHead())
+        if (auto position = playHead->getPosition())
+            if (auto bpm = position->getBpm())
+                hostBpm.store(*bpm);
+
+    for (auto* voice : voices)
     {
-        auto mix = parameters.getRawParameterValue("reverbMix")->load();
-        auto size = parameters.getRawParameterValue("reverbSize")->load();
-        auto damp = parameters.getRawParameterValue("reverbDamp")->load();
+        stats.activeVoices += voice->isVoiceActive() ? 1 : 0;
+        stats.steals += voice->takeSteals();
+    }
+
+    lap(0);
 
-        auto params = reverb.getParameters();
-        params.wetLevel = mix;
-        params.roomSize = size;
-        params.damping = damp;
-        reverb.setParameters(params);
-        reverb.processStereo(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
+    // FX, in the user's order. Each stage sleeps once its input is silent and its tail has died away
+    for (int i = 0; i < plan->numSteps; ++i)
+    {
+        plan->run[(size_t) i](*this, buffer);
+        lap(1 + plan->stage[(size_t) i]);
     }
 
+    RAVELAND_TRACE_SCOPE("master");
     const auto masterGainDb = parameters.getRawParameterValue("masterGain")->load();
     const auto gain = juce::Decibels::decibelsToGain(masterGainDb);
     buffer.applyGain(gain);
+
+    // True-peak limiter on the master; switching it changes the reported latency
+    const bool limiterOn = parameters.getRawParameterValue("limiterEnabled")->load() > 0.5f;
+    if (limiterOn != limiterActive)
+    {
+        limiterActive = limiterOn;
+        limiter.reset();
+        postLatencyChange();
+    }
+
+    if (limiterOn)
+    {
+        limiter.setCeilingDb(parameters.getRawParameterValue("limiterCeiling")->load());
+        limiter.process(buffer);
+    }
+
+    masterScope.push(buffer.getReadPointer(0), buffer.getNumChannels() > 1 ? buffer.getReadPointer(1) : nullptr, numSamples);
+
+    lap(DspLoadMeter::numSections - 1);
+    finishBlock(stats);
+}
+
+void RavelandAudioProcessor::pushScopeSilence(int numSamples)
+{
+    for (int bus = 0; bus < (int) scopeBuses.size(); ++bus)
+        getScopeForBus(bus).pushSilence(numSamples);
+
+    masterScope.pushSilence(numSamples);
+}
+
+void RavelandAudioProcessor::finishBlock(const DspLoadMeter::Block& stats)
+{
+    if (timingEnabled)
+    {
+        for (size_t s = 0; s < stats.ticks.size(); ++s)
+            timings.ticks[s] += stats.ticks[s];
+
+        ++timings.blocks;
+    }
+
+    loadMeter.push(stats);
+}
+
+void RavelandAudioProcessor::runChorus(RavelandAudioProcessor& p, juce::AudioBuffer<float>& buffer)
+{
+    RAVELAND_TRACE_SCOPE("chorus");
+    auto& activity = p.stageActivity[FxChain::chorus];
+    const auto chorusMix = p.parameters.getRawParameterValue("chorusMix")->load();
+    const auto chorusRate = p.parameters.getRawParameterValue("chorusRate")->load();
+    const auto chorusDepth = p.parameters.getRawParameterValue("chorusDepth")->load();
+
+    if (!activity.begin(buffer, chorusMix > 0.0f))
+        return;
+
+    // One wide multi-tap ensemble, or the single-tap classic chorus. A mode switch starts
+    // the incoming chorus clean, so it doesn't replay what it held when last used.
+    const bool ensemble = p.parameters.getRawParameterValue("chorusMode")->load() > 0.5f;
+    const bool switched = ensemble != p.chorusEnsemble;
+    p.chorusEnsemble = ensemble;
+
+    if (ensemble)
+    {
+        if (activity.needsReset() || switched)
+            p.ensembleChorus.reset();
+
+        p.ensembleChorus.setVoices((int) p.parameters.getRawParameterValue("chorusVoices")->load());
+        p.ensembleChorus.setParameters(chorusRate, chorusDepth, chorusMix);
+        p.ensembleChorus.process(buffer);
+    }
+    else
+    {
+        if (activity.needsReset() || switched)
+            p.chorus.reset();
+
+        juce::dsp::AudioBlock<float> block(buffer);
+        juce::dsp::ProcessContextReplacing<float> context(block);
+
+        p.chorus.setMix(chorusMix);
+        p.chorus.setRate(chorusRate);
+        p.chorus.setDepth(chorusDepth);
+        p.chorus.process(context);
+    }
+
+    activity.end(buffer);
+}
+
+void RavelandAudioProcessor::runDistortion(RavelandAudioProcessor& p, juce::AudioBuffer<float>& buffer)
+{
+    RAVELAND_TRACE_SCOPE("distortion");
+    const auto oversampling = (int) p.parameters.getRawParameterValue("distOversampling")->load();
+    if (oversampling != p.distortion.getOversamplingIndex())
+    {
+        p.distortion.setOversamplingIndex(oversampling);
+        p.distortionLatency.store(p.distortion.getLatencySamples());
+        p.postLatencyChange();
+    }
+
+    // Runs even at zero mix while awake, to keep its latency
+    auto& activity = p.stageActivity[FxChain::distortion];
+    if (!activity.begin(buffer, true))
+        return;
+
+    p.distortion.setParameters(p.parameters.getRawParameterValue("distMix")->load(),
+                               p.parameters.getRawParameterValue("distDrive")->load(),
+                               p.parameters.getRawParameterValue("distTone")->load());
+    p.distortion.process(buffer);
+    activity.end(buffer);
+}
+
+void RavelandAudioProcessor::runDelay(RavelandAudioProcessor& p, juce::AudioBuffer<float>& buffer)
+{
+    RAVELAND_TRACE_SCOPE("delay");
+    // Free-running in ms, or a note division of the host tempo
+    const auto delayTimeMs = p.getDelayTimeMs();
+    const auto delayMix = p.parameters.getRawParameterValue("delayMix")->load();
+
+    auto& activity = p.stageActivity[FxChain::delay];
+    activity.setHoldSamples((int) (p.spec.sampleRate * delayTimeMs / 1000.0) + buffer.getNumSamples());
+
+    if (!activity.begin(buffer, delayMix > 0.0f))
+        return;
+
+    if (activity.needsReset())
+        p.delay.reset();
+
+    p.delay.setDelayTimeMs(delayTimeMs);
+    p.delay.setFeedback(p.parameters.getRawParameterValue("delayFeedback")->load());
+    p.delay.setMix(delayMix);
+    p.delay.process(buffer, buffer.getNumSamples());
+    activity.end(buffer);
+}
+
+void RavelandAudioProcessor::runReverb(RavelandAudioProcessor& p, juce::AudioBuffer<float>& buffer)
+{
+    RAVELAND_TRACE_SCOPE("reverb");
+    // Convolution once an IR is in, algorithmic otherwise
+    const auto reverbMix = p.parameters.getRawParameterValue("reverbMix")->load();
+    const bool convolution = p.parameters.getRawParameterValue("reverbMode")->load() > 0.5f && p.convolutionReverb.isReady();
+
+    auto& activity = p.stageActivity[FxChain::reverb];
+    activity.setHoldSamples(convolution ? (int) (p.spec.sampleRate * p.convolutionReverb.getImpulseLengthSeconds())
+                                        : (int) (p.spec.sampleRate * 0.1));
+
+    if (!activity.begin(buffer, reverbMix > 0.0f))
+        return;
+
+    if (convolution)
+    {
+        if (activity.needsReset())
+            p.convolutionReverb.reset();
+
+        p.convolutionReverb.setMix(reverbMix);
+        p.convolutionReverb.process(buffer, p.isNonRealtime());
+    }
+    else
+    {
+        if (activity.needsReset())
+            p.reverb.reset();
+
+        p.reverb.setParameters(p.parameters.getRawParameterValue("reverbSize")->load(),
+                               p.parameters.getRawParameterValue("reverbDamp")->load(),
+                               reverbMix);
+        p.reverb.process(buffer);
+    }
+
+    activity.end(buffer);
+}
+
+void RavelandAudioProcessor::setFxChain(const FxChain& chain)
+{
+    static constexpr FxPlan::StageFunction stageFunctions[FxChain::numStages] = { runChorus, runDistortion, runDelay, runReverb };
+
+    auto plan = std::make_unique<FxPlan>();
+    for (auto stage : chain.order)
+    {
+        if (!chain.enabled[(size_t) stage])
+            continue;
+
+        plan->run[(size_t) plan->numSteps] = stageFunctions[stage];
+        plan->stage[(size_t) plan->numSteps] = stage;
+        ++plan->numSteps;
+    }
+
+    fxChain = chain;
+    fxPlan.store(plan.get(), std::memory_order_release);
+
+    // The audio thread may still be running the old plan for the rest of its block
+    const auto now = juce::Time::getMillisecondCounter();
+    retiredFxPlans.erase(std::remove_if(retiredFxPlans.begin(), retiredFxPlans.end(),
+                                        [now] (const auto& retired) { return now - retired.first > 1000; }),
+                         retiredFxPlans.end());
+
+    if (fxPlanOwner != nullptr)
+        retiredFxPlans.emplace_back(now, std::move(fxPlanOwner));
+
+    fxPlanOwner = std::move(plan);
+
+    parameters.state.setProperty("fxChain", chain.toString(), nullptr);
+    updateLatency();
+}
+
+bool RavelandAudioProcessor::isAnyVoiceActive() const
+{
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (synth.getVoice(i)->isVoiceActive())
+            return true;
+
+    return false;
+}
+
+bool RavelandAudioProcessor::isAnyStageAwake(const FxPlan& plan) const
+{
+    for (int i = 0; i < plan.numSteps; ++i)
+        if (stageActivity[(size_t) plan.stage[(size_t) i]].isAwake())
+            return true;
+
+    return false;
+}
+
+float RavelandAudioProcessor::getDelayTimeMs() const
+{
+    const auto bpm = hostBpm.load();
+    if (parameters.getRawParameterValue("delaySync")->load() > 0.5f && bpm > 0.0)
+    {
+        const auto division = (int) parameters.getRawParameterValue("delaySyncDiv")->load();
+        return (float) (60000.0 / bpm * StereoDelay::getSyncDivisionBeats(division));
+    }
+
+    return parameters.getRawParameterValue("delayTime")->load();
+}
+
+double RavelandAudioProcessor::getTailLengthSeconds() const
+{
+    // Echoes fall below -60 dB after log(0.001) / log(feedback) repeats
+    double delayTail = 0.0;
+    if (fxChain.enabled[FxChain::delay] && parameters.getRawParameterValue("delayMix")->load() > 0.0f)
+    {
+        const auto feedback = juce::jlimit(0.0, 0.999, (double) parameters.getRawParameterValue("delayFeedback")->load());
+        const auto repeats = feedback > 0.001 ? std::log(0.001) / std::log(feedback) : 1.0;
+        delayTail = repeats * getDelayTimeMs() / 1000.0;
+    }
+
+    double reverbTail = 0.0;
+    if (fxChain.enabled[FxChain::reverb] && parameters.getRawParameterValue("reverbMix")->load() > 0.0f)
+    {
+        reverbTail = parameters.getRawParameterValue("reverbMode")->load() > 0.5f && convolutionReverb.isReady()
+                         ? convolutionReverb.getImpulseLengthSeconds()
+                         : FdnReverb::getDecaySecondsForSize(parameters.getRawParameterValue("reverbSize")->load());
+    }
+
+    // The stages are in series, so their tails add
+    return delayTail + reverbTail;
+}
+
+bool RavelandAudioProcessor::loadSampleLayer(int layerIndex, const juce::File& source)
+{
+    if (layerIndex < 0 || layerIndex >= (int) sampleLayers.size())
+        return false;
+
+    // Decode (or pick up shared copies) off the audio thread, then swap in
+    SampleLayer loaded;
+    if (isSamplePreconversionEnabled())
+    {
+        loaded.setResampleCacheDirectory(SampleLayer::getDefaultResampleCacheDirectory());
+        preconvertedRate = getSampleRate();
+    }
+
+    const bool ok = source.hasFileExtension(SampleBank::fileExtension) ? loaded.loadFromBank(source)
+                                                                      : loaded.loadFromFolder(source, getSampleRate());
+    if (!ok)
+        return false;
+
+    swapInLayer(layerIndex, loaded);
+    parameters.state.setProperty("layer" + juce::String(layerIndex + 1) + "Source", source.getFullPathName(), nullptr);
+    return true;
+}
+
+void RavelandAudioProcessor::unloadSampleLayer(int layerIndex)
+{
+    if (layerIndex < 0 || layerIndex >= (int) sampleLayers.size())
+        return;
+
+    SampleLayer empty;
+    swapInLayer(layerIndex, empty);
+    parameters.state.removeProperty("layer" + juce::String(layerIndex + 1) + "Source", nullptr);
+}
+
+void RavelandAudioProcessor::setSamplePreconversion(bool shouldPreconvert)
+{
+    parameters.state.setProperty("preconvertSamples", shouldPreconvert, nullptr);
+
+    if (preconvertSamples.exchange(shouldPreconvert) != shouldPreconvert)
+        reloadSampleFolders();
+}
+
+void RavelandAudioProcessor::reloadSampleFolders()
+{
+    // Banks are stored at their source rates and never pre-converted
+    for (int i = 0; i < (int) sampleLayers.size(); ++i)
+    {
+        const auto source = getSampleLayerSource(i);
+        if (source.isDirectory())
+            loadSampleLayer(i, source);
+    }
+}
+
+void RavelandAudioProcessor::handleAsyncUpdate()
+{
+    if (latencyChanged.exchange(false))
+        updateLatency();
+
+    if (isSamplePreconversionEnabled() && getSampleRate() != preconvertedRate)
+        reloadSampleFolders();
+}
+
+void RavelandAudioProcessor::swapInLayer(int layerIndex, SampleLayer& layer)
+{
+    {
+        const juce::SpinLock::ScopedLockType sl(layerLock);
+        std::swap(sampleLayers[(size_t) layerIndex], layer);
+    }
+
+    // `layer` now holds the previous references, released on the caller's thread
+    // rather than the audio thread
+    layer = SampleLayer();
+}
+
+void RavelandAudioProcessor::loadReverbImpulse(const juce::File& file)
+{
+    convolutionReverb.loadImpulseResponse(file);
+    parameters.state.setProperty("reverbImpulse", file.getFullPathName(), nullptr);
+}
+
+void RavelandAudioProcessor::setSampleMemoryBudget(juce::int64 bytes)
+{
+    samplePool->setMemoryBudget(bytes);
+    parameters.state.setProperty("sampleMemoryBudget", bytes, nullptr);
+}
+
+juce::File RavelandAudioProcessor::getSampleLayerSource(int layerIndex) const
+{
+    const auto path = parameters.state.getProperty("layer" + juce::String(layerIndex + 1) + "Source").toString();
+    return path.isNotEmpty() ? juce::File(path) : juce::File();
 }
 
 juce::AudioProcessorEditor* RavelandAudioProcessor::createEditor()
@@ -338,7 +786,31 @@ void RavelandAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 void RavelandAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
     if (auto xml = getXmlFromBinary(data, sizeInBytes))
+    {
         parameters.replaceState(juce::ValueTree::fromXml(*xml));
+
+        const auto impulse = parameters.state.getProperty("reverbImpulse").toString();
+        if (impulse.isNotEmpty())
+            convolutionReverb.loadImpulseResponse(juce::File(impulse));
+
+        setFxChain(FxChain::fromString(parameters.state.getProperty("fxChain").toString()));
+
+        preconvertSamples.store((bool) parameters.state.getProperty("preconvertSamples", false));
+
+        if (parameters.state.hasProperty("sampleMemoryBudget"))
+            samplePool->setMemoryBudget((juce::int64) parameters.state.getProperty("sampleMemoryBudget"));
+
+        for (int i = 0; i < (int) sampleLayers.size(); ++i)
+        {
+            // A missing stack keeps its path in the state so it can be relinked
+            const auto source = getSampleLayerSource(i);
+            if (source == juce::File() || !loadSampleLayer(i, source))
+            {
+                SampleLayer empty;
+                swapInLayer(i, empty);
+            }
+        }
+    }
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -3,12 +3,27 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include "SampleLayer.h"
-
-class RavelandAudioProcessor : public juce::AudioProcessor
+#include "ConvolutionReverb.h"
+#include "DistortionStage.h"
+#include "DspLoadMeter.h"
+#include "EnsembleChorus.h"
+#include "FdnReverb.h"
+#include "FxChain.h"
+#include "SamplePool.h"
+#include "ScopeCapture.h"
+#include "StageActivity.h"
+#include "StereoDelay.h"
+#include "TraceRecorder.h"
+#include "TruePeakLimiter.h"
+
+class RavelandVoice;
+
+class RavelandAudioProcessor : public juce::AudioProcessor,
+                               private juce::AsyncUpdater
 {
 public:
     RavelandAudioProcessor();
-    ~RavelandAudioProcessor() override = default;
+    ~RavelandAudioProcessor() override;
 
     //==============================================================================
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
@@ -29,7 +44,7 @@ public:
     bool acceptsMidi() const override { return true; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override;
 
     //==============================================================================
     int getNumPrograms() override;
@@ -49,6 +64,55 @@ public:
     int getCurrentPresetIndex() const { return currentPresetIndex; }
     juce::StringArray getPresetNames() const;
 
+    // Sample layer stacks: a per-key WAV folder or a packed .rvlbank file
+    bool loadSampleLayer(int layerIndex, const juce::File& source);
+    void unloadSampleLayer(int layerIndex);
+    juce::File getSampleLayerSource(int layerIndex) const;
+
+    // Resample WAV stacks to the session rate once at load, cached on disk; saved with the
+    // state, and reloads the loaded stacks when changed
+    void setSamplePreconversion(bool shouldPreconvert);
+    bool isSamplePreconversionEnabled() const { return preconvertSamples.load(); }
+
+    // Impulse response for the convolution reverb mode, loaded in the background
+    void loadReverbImpulse(const juce::File& file);
+    juce::File getReverbImpulseFile() const { return convolutionReverb.getImpulseResponseFile(); }
+
+    // FX slot order and enable flags; recompiles the audio thread's plan
+    void setFxChain(const FxChain& chain);
+    const FxChain& getFxChain() const { return fxChain; }
+
+    // Process-wide cap on resident sample memory (0 = unlimited), saved with the state
+    void setSampleMemoryBudget(juce::int64 bytes);
+    SamplePool::Stats getSamplePoolStats() const { return samplePool->getStats(); }
+
+    bool isReverbImpulseReady() const { return convolutionReverb.isReady(); }
+
+    // Time spent in each part of processBlock, accumulated while enabled. For the offline
+    // tools: the fields are plain values, only safe to read between blocks.
+    struct ProcessTimings
+    {
+        static constexpr int numSections = DspLoadMeter::numSections;
+
+        std::array<juce::int64, numSections> ticks {}; // juce::Time high-resolution ticks
+        juce::int64 blocks { 0 };
+
+        static juce::String getSectionName(int section) { return DspLoadMeter::getSectionName(section); }
+    };
+
+    void setTimingEnabled(bool shouldTime) { timingEnabled = shouldTime; timings = {}; }
+    const ProcessTimings& getTimings() const { return timings; }
+
+    // Live per-section load, voices, steals and overruns, always measured; drained by the editor
+    DspLoadMeter& getLoadMeter() { return loadMeter; }
+
+    // Oscilloscope taps for the editor, each capturing only while a display shows it.
+    // The voices run a single oscillator so far, which feeds the first oscillator tap.
+    static constexpr int numScopedOscillators = 1;
+    ScopeCapture& getOscillatorScope(int index) { return oscillatorScopes[(size_t) index]; }
+    ScopeCapture& getLayerScope(int index) { return layerScopes[(size_t) index]; }
+    ScopeCapture& getMasterScope() { return masterScope; }
+
 private:
     juce::AudioProcessorValueTreeState parameters;
 
@@ -56,20 +120,99 @@ private:
 
     juce::dsp::ProcessSpec spec{};
     juce::dsp::Chorus<float> chorus;
-    juce::dsp::DelayLine<float> delay { 44100 };
-    juce::Reverb reverb;
-    juce::dsp::WaveShaper<float> distortion { [] (float x) { return std::tanh(x); } };
-
-    // Sample layers (up to 3)
+    EnsembleChorus ensembleChorus;
+    bool chorusEnsemble { false }; // audio thread: the chorus mode that ran last
+    StereoDelay delay;
+    FdnReverb reverb;
+    ConvolutionReverb convolutionReverb;
+    DistortionStage distortion;
+    TruePeakLimiter limiter;
+    bool limiterActive { false }; // audio thread
+
+    // Latency inputs the audio thread changes. It only flags the change; the message
+    // thread reports the new total to the host.
+    std::atomic<int> distortionLatency { 0 };
+    std::atomic<bool> latencyChanged { false };
+
+    // Sample layers (up to 3). Audio is shared process-wide through the pool;
+    // layerLock only guards swapping a freshly loaded layer in.
+    juce::SharedResourcePointer<SamplePool> samplePool;
+    juce::SpinLock layerLock;
     std::array<SampleLayer, 3> sampleLayers;
     std::array<bool, 3> layerEnabled { true, true, false };
     std::array<float, 3> layerGain { 0.8f, 0.7f, 0.6f };
     std::array<int, 3> layerStartRand { 35, 45, 55 };
+    std::array<std::atomic<float>*, 3> layerEnabledParams {};
+    std::array<std::atomic<float>*, 3> layerGainParams {};
+    std::array<std::atomic<float>*, 3> layerStartRandParams {};
+    std::atomic<bool> preconvertSamples { false };
+    double preconvertedRate { 0.0 }; // message thread: the rate the loaded stacks were converted to
+
+    std::atomic<double> hostBpm { 120.0 };
+
+    // The FX chain compiled to the enabled stages in order: a flat list of stage functions
+    // the audio thread calls without dispatch or per-stage enable checks. Every stage works
+    // in place on the output buffer. Plans are built on the message thread, published with
+    // one atomic store and freed a grace period after being replaced.
+    struct FxPlan
+    {
+        using StageFunction = void (*)(RavelandAudioProcessor&, juce::AudioBuffer<float>&);
+
+        std::array<StageFunction, FxChain::numStages> run {};
+        std::array<int, FxChain::numStages> stage {};
+        int numSteps { 0 };
+
+        bool contains(int s) const
+        {
+            for (int i = 0; i < numSteps; ++i)
+                if (stage[(size_t) i] == s)
+                    return true;
+            return false;
+        }
+    };
+
+    FxChain fxChain;
+    std::unique_ptr<FxPlan> fxPlanOwner;
+    std::atomic<FxPlan*> fxPlan { nullptr };
+    const FxPlan* lastFxPlan { nullptr }; // audio thread
+    std::vector<std::pair<juce::uint32, std::unique_ptr<FxPlan>>> retiredFxPlans;
+
+    std::array<StageActivity, FxChain::numStages> stageActivity;
+
+    bool timingEnabled { false };
+    ProcessTimings timings;
+    juce::File traceOutput; // set when this instance started a RAVELAND_TRACE session
+    DspLoadMeter loadMeter;
+    juce::Array<RavelandVoice*> voices;
+
+    // Scope buses, the oscillator then each layer: the voices add the watched sources in,
+    // and the processor captures them once the synth has rendered. Null while unwatched.
+    std::array<ScopeCapture, 3> oscillatorScopes;
+    std::array<ScopeCapture, 3> layerScopes;
+    ScopeCapture masterScope;
+    juce::AudioBuffer<float> scopeBusBuffer;
+    std::array<float*, 4> scopeBuses {};
 
     int currentPresetIndex = 0;
     juce::StringArray presetNames;
 
     void createFactoryPresets();
+    void updateLatency();
+    void postLatencyChange();
+    void finishBlock(const DspLoadMeter::Block& stats);
+    bool isAnyVoiceActive() const;
+    bool isAnyStageAwake(const FxPlan& plan) const;
+    float getDelayTimeMs() const;
+    void swapInLayer(int layerIndex, SampleLayer& layer);
+    void reloadSampleFolders();
+    void handleAsyncUpdate() override;
+    ScopeCapture& getScopeForBus(int bus) { return bus == 0 ? oscillatorScopes[0] : layerScopes[(size_t) (bus - 1)]; }
+    void pushScopeSilence(int numSamples);
+
+    static void runChorus(RavelandAudioProcessor&, juce::AudioBuffer<float>&);
+    static void runDistortion(RavelandAudioProcessor&, juce::AudioBuffer<float>&);
+    static void runDelay(RavelandAudioProcessor&, juce::AudioBuffer<float>&);
+    static void runReverb(RavelandAudioProcessor&, juce::AudioBuffer<float>&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RavelandAudioProcessor)
 };
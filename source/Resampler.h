@@ -0,0 +1,76 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include "DspKernels.h"
+
+/** Offline, load-time sample rate conversion.
+
+    Uses JUCE's windowed-sinc interpolator with latency compensation, preceded
+    by a linear-phase anti-aliasing FIR when converting down. Far too slow for
+    the audio thread; intended for converting samples and impulse responses once. */
+namespace Resampler
+{
+    inline void applyLowpass(juce::AudioBuffer<float>& buffer, double cutoffHz, double sampleRate)
+    {
+        constexpr size_t order = 128;
+        auto coeffs = juce::dsp::FilterDesign<float>::designFIRLowpassWindowMethod((float) cutoffHz, sampleRate, order,
+                                                                                  juce::dsp::WindowingFunction<float>::kaiser, 8.0f);
+        const float* h = coeffs->getRawCoefficients();
+        const int numTaps = (int) coeffs->getFilterOrder() + 1;
+        const int delay = numTaps / 2;
+        const int length = buffer.getNumSamples();
+
+        // Reversed, so each output is a forward dot product with the input
+        std::vector<float> reversed(h, h + numTaps);
+        std::reverse(reversed.begin(), reversed.end());
+
+        std::vector<float> filtered((size_t) length);
+        const auto& kernels = DspKernels::get();
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const float* in = buffer.getReadPointer(ch);
+
+            // Zero-phase: output n is centred on input n
+            for (int n = 0; n < length; ++n)
+            {
+                const int first = juce::jmax(0, n + delay - length + 1);
+                const int last = juce::jmin(numTaps - 1, n + delay);
+
+                filtered[(size_t) n] = kernels.dotProduct(reversed.data() + (numTaps - 1 - last),
+                                                          in + (n + delay - last), last - first + 1);
+            }
+
+            buffer.copyFrom(ch, 0, filtered.data(), length);
+        }
+    }
+
+    inline juce::AudioBuffer<float> process(const juce::AudioBuffer<float>& source, double sourceRate, double targetRate)
+    {
+        if (sourceRate <= 0.0 || targetRate <= 0.0 || source.getNumSamples() == 0 || sourceRate == targetRate)
+            return source;
+
+        juce::AudioBuffer<float> input(source);
+        if (targetRate < sourceRate)
+            applyLowpass(input, 0.45 * targetRate, sourceRate);
+
+        const double speedRatio = sourceRate / targetRate;
+        const int outLength = (int) std::ceil(input.getNumSamples() / speedRatio);
+        const int skip = juce::roundToInt(juce::WindowedSincInterpolator::getBaseLatency() / speedRatio);
+
+        juce::AudioBuffer<float> output(input.getNumChannels(), outLength);
+        std::vector<float> scratch((size_t) (outLength + skip));
+
+        for (int ch = 0; ch < input.getNumChannels(); ++ch)
+        {
+            juce::WindowedSincInterpolator interpolator;
+            interpolator.process(speedRatio, input.getReadPointer(ch), scratch.data(),
+                                 outLength + skip, input.getNumSamples(), 0);
+            output.copyFrom(ch, 0, scratch.data() + skip, outLength);
+        }
+
+        return output;
+    }
+}
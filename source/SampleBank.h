@@ -0,0 +1,302 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <array>
+#include <map>
+#include <vector>
+
+/** Packed single-file sample bank (.rvlbank).
+
+    Layout (all integers little-endian):
+        header      magic "RVLB", version, zone count, page size
+        zone table  one fixed-size entry per zone (see ZoneInfo)
+        audio data  each zone's channels stored as contiguous planar float32,
+                    every zone starting on a page boundary
+
+    A whole layer is loaded with one open and one memory map instead of
+    probing and parsing up to 128 separate WAV files. */
+class SampleBank
+{
+public:
+    static constexpr const char* fileExtension = ".rvlbank";
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr juce::uint32 pageSize = 4096;
+
+    struct ZoneInfo
+    {
+        int note { 0 };
+        int numChannels { 0 };
+        double sampleRate { 0.0 };
+        juce::int64 lengthInSamples { 0 };
+        juce::int64 loopStart { -1 };
+        juce::int64 loopEnd { -1 };
+        juce::int64 dataOffset { 0 };
+        int sourceBitsPerSample { 0 };
+        float peak { 0.0f };
+        float rms { 0.0f };
+    };
+
+    /** Audio for one zone, used when writing a bank. */
+    struct Zone
+    {
+        int note { 0 };
+        double sampleRate { 0.0 };
+        juce::AudioBuffer<float> audio;
+        juce::int64 loopStart { -1 };
+        juce::int64 loopEnd { -1 };
+        int sourceBitsPerSample { 0 };
+    };
+
+    //==============================================================================
+    /** Maps a bank file and parses its zone table. The mapping stays open until
+        this object is destroyed or another file is opened. */
+    bool open(const juce::File& file)
+    {
+        zones.clear();
+        mappedFile.reset();
+        bankFingerprint = 0;
+
+       #if JUCE_BIG_ENDIAN
+        juce::ignoreUnused(file);
+        return false; // audio data is stored as little-endian float
+       #else
+        auto map = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        const auto* base = static_cast<const char*>(map->getData());
+        const auto fileSize = (juce::int64) map->getSize();
+
+        if (base == nullptr || fileSize < headerSize)
+            return false;
+
+        if (std::memcmp(base, "RVLB", 4) != 0 || readUInt32(base + 4) != currentVersion)
+            return false;
+
+        const auto numZones = (int) readUInt32(base + 8);
+        if (numZones < 0 || numZones > 128 || headerSize + (juce::int64) numZones * zoneEntrySize > fileSize)
+            return false;
+
+        zones.reserve((size_t) numZones);
+
+        for (int i = 0; i < numZones; ++i)
+        {
+            const char* entry = base + headerSize + i * zoneEntrySize;
+
+            ZoneInfo z;
+            z.note                = (int) readUInt32(entry);
+            z.numChannels         = (int) readUInt32(entry + 4);
+            z.sampleRate          = readDouble(entry + 8);
+            z.lengthInSamples     = (juce::int64) readUInt64(entry + 16);
+            z.loopStart           = (juce::int64) readUInt64(entry + 24);
+            z.loopEnd             = (juce::int64) readUInt64(entry + 32);
+            z.dataOffset          = (juce::int64) readUInt64(entry + 40);
+            z.sourceBitsPerSample = (int) readUInt32(entry + 48);
+            z.peak                = readFloat(entry + 52);
+            z.rms                 = readFloat(entry + 56);
+
+            const auto bytes = z.lengthInSamples * z.numChannels * (juce::int64) sizeof(float);
+
+            if (z.note < 0 || z.note >= 128 || z.numChannels <= 0 || z.sampleRate <= 0.0
+                || z.lengthInSamples <= 0 || z.lengthInSamples > std::numeric_limits<int>::max()
+                || z.dataOffset < 0 || z.dataOffset + bytes > fileSize)
+                return false;
+
+            zones.push_back(z);
+        }
+
+        bankFingerprint = fingerprint(file, base, (size_t) (headerSize + numZones * zoneEntrySize));
+        mappedFile = std::move(map);
+        return true;
+       #endif
+    }
+
+    int getNumZones() const                          { return (int) zones.size(); }
+    const ZoneInfo& getZone(int index) const         { return zones[(size_t) index]; }
+
+    /** Returns a pointer into the mapped file for one channel of a zone. */
+    const float* getChannelData(int zoneIndex, int channel) const
+    {
+        const auto& z = zones[(size_t) zoneIndex];
+        const auto* base = static_cast<const char*>(mappedFile->getData());
+        return reinterpret_cast<const float*>(base + z.dataOffset
+                                              + (juce::int64) channel * z.lengthInSamples * (juce::int64) sizeof(float));
+    }
+
+    //==============================================================================
+    /** Writes a bank. Zones are sorted by note; notes must be unique. */
+    static bool write(const juce::File& file, std::vector<Zone> zonesToWrite)
+    {
+       #if JUCE_BIG_ENDIAN
+        juce::ignoreUnused(file, zonesToWrite);
+        return false; // audio data is stored as little-endian float
+       #else
+        std::sort(zonesToWrite.begin(), zonesToWrite.end(),
+                  [] (const Zone& a, const Zone& b) { return a.note < b.note; });
+
+        file.deleteFile();
+        juce::FileOutputStream out(file);
+        if (!out.openedOk())
+            return false;
+
+        const auto numZones = (int) zonesToWrite.size();
+        juce::int64 offset = alignToPage(headerSize + (juce::int64) numZones * zoneEntrySize);
+
+        out.write("RVLB", 4);
+        out.writeInt((int) currentVersion);
+        out.writeInt(numZones);
+        out.writeInt((int) pageSize);
+
+        std::vector<juce::int64> offsets;
+        for (const auto& z : zonesToWrite)
+        {
+            offsets.push_back(offset);
+            offset = alignToPage(offset + (juce::int64) z.audio.getNumChannels() * z.audio.getNumSamples() * (juce::int64) sizeof(float));
+        }
+
+        for (int i = 0; i < numZones; ++i)
+        {
+            const auto& z = zonesToWrite[(size_t) i];
+            const auto stats = measure(z.audio);
+
+            out.writeInt(z.note);
+            out.writeInt(z.audio.getNumChannels());
+            out.writeDouble(z.sampleRate);
+            out.writeInt64(z.audio.getNumSamples());
+            out.writeInt64(z.loopStart);
+            out.writeInt64(z.loopEnd);
+            out.writeInt64(offsets[(size_t) i]);
+            out.writeInt(z.sourceBitsPerSample);
+            out.writeFloat(stats.first);
+            out.writeFloat(stats.second);
+            out.writeInt(0); // reserved
+        }
+
+        for (int i = 0; i < numZones; ++i)
+        {
+            const auto& z = zonesToWrite[(size_t) i];
+            padTo(out, offsets[(size_t) i]);
+
+            for (int ch = 0; ch < z.audio.getNumChannels(); ++ch)
+                out.write(z.audio.getReadPointer(ch), (size_t) z.audio.getNumSamples() * sizeof(float));
+        }
+
+        out.flush();
+        return out.getStatus().wasOk();
+       #endif
+    }
+
+    //==============================================================================
+    /** Finds the per-key WAV files in a stack folder with a single directory scan.
+        Accepts note names (C-1.wav, C#-1.wav, ...) or numeric names (000.wav ... 127.wav);
+        the note name wins when both exist. */
+    static std::array<juce::File, 128> findNoteFiles(const juce::File& folder)
+    {
+        std::array<juce::File, 128> result;
+        std::array<bool, 128> namedMatch {};
+
+        std::map<juce::String, int> noteLookup;
+        for (int note = 0; note < 128; ++note)
+        {
+            auto noteName = juce::MidiMessage::getMidiNoteName(note, true, true, 4).replaceCharacter(' ', '-');
+            noteLookup[noteName.toLowerCase()] = note;
+        }
+
+        for (const auto& entry : juce::RangedDirectoryIterator(folder, false, "*.wav", juce::File::findFiles))
+        {
+            const auto& file = entry.getFile();
+            const auto stem = file.getFileNameWithoutExtension();
+
+            auto it = noteLookup.find(stem.toLowerCase());
+            if (it != noteLookup.end())
+            {
+                result[(size_t) it->second] = file;
+                namedMatch[(size_t) it->second] = true;
+                continue;
+            }
+
+            if (stem.length() == 3 && stem.containsOnly("0123456789"))
+            {
+                const int note = stem.getIntValue();
+                if (note < 128 && !namedMatch[(size_t) note])
+                    result[(size_t) note] = file;
+            }
+        }
+
+        return result;
+    }
+
+    /** 64-bit FNV-1a fingerprint of a file's path, size and modification time, plus
+        optional header bytes. Used to key caches without reading the file through. */
+    static juce::uint64 fingerprint(const juce::File& file, const void* header = nullptr, size_t headerBytes = 0)
+    {
+        const auto path = file.getFullPathName();
+        const juce::int64 stamp[] = { file.getSize(), file.getLastModificationTime().toMilliseconds() };
+
+        auto hash = fnv1a(0xcbf29ce484222325ULL, path.toRawUTF8(), path.getNumBytesAsUTF8());
+        hash = fnv1a(hash, stamp, sizeof(stamp));
+        return fnv1a(hash, header, headerBytes);
+    }
+
+    /** The fingerprint of the open bank, covering its header and zone table. */
+    juce::uint64 getFingerprint() const     { return bankFingerprint; }
+
+private:
+    static constexpr int headerSize = 16;
+    static constexpr int zoneEntrySize = 64;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    std::vector<ZoneInfo> zones;
+    juce::uint64 bankFingerprint { 0 };
+
+    static juce::uint64 fnv1a(juce::uint64 hash, const void* data, size_t numBytes)
+    {
+        const auto* bytes = static_cast<const juce::uint8*>(data);
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+        return hash;
+    }
+
+    static juce::int64 alignToPage(juce::int64 offset)
+    {
+        return (offset + pageSize - 1) / pageSize * pageSize;
+    }
+
+    static void padTo(juce::OutputStream& out, juce::int64 offset)
+    {
+        while (out.getPosition() < offset)
+            out.writeByte(0);
+    }
+
+    static std::pair<float, float> measure(const juce::AudioBuffer<float>& audio)
+    {
+        float peak = 0.0f;
+        double sumSquares = 0.0;
+
+        for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+        {
+            peak = juce::jmax(peak, audio.getMagnitude(ch, 0, audio.getNumSamples()));
+            const float rms = audio.getRMSLevel(ch, 0, audio.getNumSamples());
+            sumSquares += (double) rms * rms;
+        }
+
+        const auto numChannels = juce::jmax(1, audio.getNumChannels());
+        return { peak, (float) std::sqrt(sumSquares / numChannels) };
+    }
+
+    static juce::uint32 readUInt32(const char* p)   { return juce::ByteOrder::littleEndianInt(p); }
+    static juce::uint64 readUInt64(const char* p)   { return juce::ByteOrder::littleEndianInt64(p); }
+
+    static double readDouble(const char* p)
+    {
+        const auto bits = readUInt64(p);
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    static float readFloat(const char* p)
+    {
+        const auto bits = readUInt32(p);
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+};
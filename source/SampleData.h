@@ -0,0 +1,465 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define RAVELAND_SAMPLEDATA_SSE2 1
+ #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #define RAVELAND_SAMPLEDATA_NEON 1
+ #include <arm_neon.h>
+#endif
+
+/** Audio for one key zone held in a compact encoding.
+
+    Most stacks are 16 or 24 bit, so keeping them as 32-bit float wastes 2x/1.33x
+    memory and the bandwidth to stream it. Samples stay in their integer form (or a
+    lossless delta/bit-packed block form) and are converted to float in small chunks
+    by read(), right before the playback kernel interpolates them. */
+class SampleData
+{
+public:
+    enum class Encoding
+    {
+        float32,
+        int16,
+        int24,
+        compressed  // lossless, per-block first-order delta + zigzag + bit packing
+    };
+
+    /** Samples per compressed block; also the granularity of random access. */
+    static constexpr int blockSize = 256;
+
+    SampleData() = default;
+
+    /** Encodes float audio. For int16/int24/compressed the input must already be
+        quantised to bitsPerSample (as read from a 16/24-bit file) to be lossless. */
+    static SampleData create(const juce::AudioBuffer<float>& audio, double sampleRate, Encoding encoding, int bitsPerSample)
+    {
+        SampleData d;
+        d.sampleRate = sampleRate;
+        d.numChannels = audio.getNumChannels();
+        d.numSamples = audio.getNumSamples();
+        d.encoding = encoding;
+
+        if (encoding == Encoding::int16)
+            bitsPerSample = 16;
+        else if (encoding == Encoding::int24)
+            bitsPerSample = 24;
+        else if (encoding == Encoding::compressed && (bitsPerSample <= 0 || bitsPerSample > 24))
+            d.encoding = Encoding::float32;
+
+        d.bitsPerSample = d.encoding == Encoding::float32 ? 32 : bitsPerSample;
+        d.scale = d.encoding == Encoding::float32 ? 1.0f : 1.0f / (float) (1 << (d.bitsPerSample - 1));
+
+        const auto total = (size_t) d.numChannels * (size_t) d.numSamples;
+
+        switch (d.encoding)
+        {
+            case Encoding::float32:
+                d.storage.resize(total * sizeof(float));
+                for (int ch = 0; ch < d.numChannels; ++ch)
+                    std::memcpy(d.storage.data() + (size_t) ch * d.numSamples * sizeof(float),
+                                audio.getReadPointer(ch), (size_t) d.numSamples * sizeof(float));
+                break;
+
+            case Encoding::int16:
+                d.storage.resize(total * 2);
+                for (int ch = 0; ch < d.numChannels; ++ch)
+                {
+                    auto* dest = d.storage.data() + (size_t) ch * d.numSamples * 2;
+                    for (int i = 0; i < d.numSamples; ++i)
+                    {
+                        const auto v = (juce::int16) d.quantise(audio.getSample(ch, i));
+                        std::memcpy(dest + (size_t) i * 2, &v, 2);
+                    }
+                }
+                break;
+
+            case Encoding::int24:
+                d.storage.resize(total * 3);
+                for (int ch = 0; ch < d.numChannels; ++ch)
+                {
+                    auto* dest = d.storage.data() + (size_t) ch * d.numSamples * 3;
+                    for (int i = 0; i < d.numSamples; ++i)
+                    {
+                        const auto v = (juce::uint32) d.quantise(audio.getSample(ch, i));
+                        dest[i * 3]     = (juce::uint8) (v & 0xff);
+                        dest[i * 3 + 1] = (juce::uint8) ((v >> 8) & 0xff);
+                        dest[i * 3 + 2] = (juce::uint8) ((v >> 16) & 0xff);
+                    }
+                }
+                break;
+
+            case Encoding::compressed:
+                d.compress(audio);
+                break;
+        }
+
+        d.buildStartPointIndex(audio);
+        return d;
+    }
+
+    bool isEmpty() const                     { return numSamples == 0; }
+    int getNumChannels() const               { return numChannels; }
+    int getNumSamples() const                { return numSamples; }
+    double getSampleRate() const             { return sampleRate; }
+    Encoding getEncoding() const             { return encoding; }
+
+    size_t getSizeInBytes() const
+    {
+        return storage.size() + blockOffsets.size() * sizeof(juce::uint32)
+             + startPoints.capacity() * sizeof(StartPoint) + sizeof(startPointsWithinPercent);
+    }
+
+    //==============================================================================
+    /** A candidate start offset for randomised note starts: a zero crossing whose
+        slope matches the sample's own onset, with the RMS of the audio that follows. */
+    struct StartPoint
+    {
+        int position { 0 };
+        float rms { 0.0f };
+    };
+
+    /** Fraction of the sample that a StartRand of 100% may skip into. */
+    static constexpr double maxStartOffsetFraction = 0.5;
+
+    /** Picks a start point within the first startRandPercent of the randomisation
+        window in constant time. Returns 0 when there is nothing to pick from. */
+    int pickStartPoint(int startRandPercent, juce::Random& random) const noexcept
+    {
+        const auto count = (int) startPointsWithinPercent[(size_t) juce::jlimit(0, 100, startRandPercent)];
+        if (count == 0)
+            return 0;
+
+        return startPoints[(size_t) random.nextInt(count)].position;
+    }
+
+    const std::vector<StartPoint>& getStartPoints() const { return startPoints; }
+
+    /** Decodes [start, start + num) of one channel to float. The range must lie inside the sample. */
+    void read(int channel, int start, int num, float* dest) const
+    {
+        jassert(start >= 0 && num >= 0 && start + num <= numSamples);
+
+        const auto* src = storage.data();
+
+        switch (encoding)
+        {
+            case Encoding::float32:
+                std::memcpy(dest, src + ((size_t) channel * numSamples + (size_t) start) * sizeof(float), (size_t) num * sizeof(float));
+                break;
+
+            case Encoding::int16:
+                decodeInt16(src + ((size_t) channel * numSamples + (size_t) start) * 2, dest, num, scale);
+                break;
+
+            case Encoding::int24:
+                decodeInt24(src + ((size_t) channel * numSamples + (size_t) start) * 3, dest, num, scale);
+                break;
+
+            case Encoding::compressed:
+            {
+                const int numBlocks = getNumBlocks();
+                float block[blockSize];
+
+                while (num > 0)
+                {
+                    const int blockIndex = start / blockSize;
+                    const int offsetInBlock = start - blockIndex * blockSize;
+                    const int blockLength = juce::jmin(blockSize, numSamples - blockIndex * blockSize);
+                    const int count = juce::jmin(num, blockLength - offsetInBlock);
+
+                    if (offsetInBlock == 0 && count == blockLength)
+                    {
+                        decodeBlock(blockOffsets[(size_t) (channel * numBlocks + blockIndex)], blockLength, dest);
+                    }
+                    else
+                    {
+                        decodeBlock(blockOffsets[(size_t) (channel * numBlocks + blockIndex)], blockLength, block);
+                        std::memcpy(dest, block + offsetInBlock, (size_t) count * sizeof(float));
+                    }
+
+                    dest += count;
+                    start += count;
+                    num -= count;
+                }
+                break;
+            }
+        }
+    }
+
+    //==============================================================================
+    static void decodeInt16(const juce::uint8* src, float* dest, int num, float scale) noexcept
+    {
+        int i = 0;
+
+       #if RAVELAND_SAMPLEDATA_SSE2
+        const auto vScale = _mm_set1_ps(scale);
+        for (; i + 8 <= num; i += 8)
+        {
+            const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+            const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(dest + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), vScale));
+            _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vScale));
+        }
+       #elif RAVELAND_SAMPLEDATA_NEON
+        for (; i + 8 <= num; i += 8)
+        {
+            const auto v = vld1q_s16(reinterpret_cast<const int16_t*>(src + i * 2));
+            vst1q_f32(dest + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+            vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+        }
+       #endif
+
+        for (; i < num; ++i)
+        {
+            juce::int16 v;
+            std::memcpy(&v, src + i * 2, 2);
+            dest[i] = (float) v * scale;
+        }
+    }
+
+    static void decodeInt24(const juce::uint8* src, float* dest, int num, float scale) noexcept
+    {
+        int i = 0;
+
+       #if RAVELAND_SAMPLEDATA_SSE2
+        // Four samples from one unaligned 16-byte load, which reads up to six samples'
+        // worth, so stop while the overread is still inside the range
+        const auto vScale = _mm_set1_ps(scale);
+        for (; i + 6 <= num; i += 4)
+        {
+            const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            const auto s01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+            const auto s23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+            const auto s = _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi64(s01, s23), 8), 8);
+            _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(s), vScale));
+        }
+       #elif RAVELAND_SAMPLEDATA_NEON
+        for (; i + 8 <= num; i += 8)
+        {
+            // De-interleaves the low, middle and high bytes of eight samples
+            const auto bytes = vld3_u8(src + i * 3);
+            const auto low = vorrq_u16(vmovl_u8(bytes.val[0]), vshll_n_u8(bytes.val[1], 8));
+            const auto high = vmovl_s8(vreinterpret_s8_u8(bytes.val[2]));
+            const auto lo = vorrq_s32(vshll_n_s16(vget_low_s16(high), 16), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+            const auto hi = vorrq_s32(vshll_n_s16(vget_high_s16(high), 16), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+            vst1q_f32(dest + i,     vmulq_n_f32(vcvtq_f32_s32(lo), scale));
+            vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), scale));
+        }
+       #endif
+
+        for (; i < num; ++i)
+        {
+            const auto* p = src + i * 3;
+            const auto v = (juce::int32) (((juce::uint32) p[0] << 8) | ((juce::uint32) p[1] << 16) | ((juce::uint32) p[2] << 24)) >> 8;
+            dest[i] = (float) v * scale;
+        }
+    }
+
+private:
+    Encoding encoding { Encoding::float32 };
+    double sampleRate { 0.0 };
+    int numChannels { 0 };
+    int numSamples { 0 };
+    int bitsPerSample { 32 };
+    float scale { 1.0f };
+
+    std::vector<juce::uint8> storage;
+    std::vector<juce::uint32> blockOffsets; // compressed only: [channel * numBlocks + block]
+
+    std::vector<StartPoint> startPoints;                 // sorted by position
+    std::array<juce::uint32, 101> startPointsWithinPercent {}; // candidates usable at each StartRand value
+
+    /** Scans the (mono-summed) audio once at load time so note-on never has to. */
+    void buildStartPointIndex(const juce::AudioBuffer<float>& audio)
+    {
+        constexpr int rmsWindow = 256;
+        constexpr size_t maxPoints = 4096;
+
+        startPoints.clear();
+        startPointsWithinPercent.fill(0);
+
+        const int window = (int) (numSamples * maxStartOffsetFraction);
+        if (window <= 1 || numChannels == 0)
+            return;
+
+        auto mono = [&] (int i)
+        {
+            float sum = 0.0f;
+            for (int ch = 0; ch < numChannels; ++ch)
+                sum += audio.getSample(ch, i);
+            return sum;
+        };
+
+        // Match the onset direction so every start sounds like the original attack
+        bool rising = true;
+        for (int i = 1; i < juce::jmin(numSamples, rmsWindow); ++i)
+        {
+            const auto slope = mono(i) - mono(0);
+            if (slope != 0.0f)
+            {
+                rising = slope > 0.0f;
+                break;
+            }
+        }
+
+        // Running sum of squares gives O(1) RMS of the window after each crossing
+        std::vector<double> energy((size_t) numSamples + 1, 0.0);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double v = mono(i);
+            energy[(size_t) i + 1] = energy[(size_t) i] + v * v;
+        }
+
+        auto rmsAt = [&] (int start)
+        {
+            const int end = juce::jmin(numSamples, start + rmsWindow);
+            return (float) std::sqrt((energy[(size_t) end] - energy[(size_t) start]) / juce::jmax(1, end - start)) / (float) numChannels;
+        };
+
+        const float overallRms = (float) std::sqrt(energy[(size_t) numSamples] / numSamples) / (float) numChannels;
+        const float minimumRms = overallRms * 0.1f; // skip near-silent gaps
+
+        float previous = mono(0);
+        for (int i = 1; i < window; ++i)
+        {
+            const float current = mono(i);
+            const bool crossed = rising ? (previous < 0.0f && current >= 0.0f)
+                                        : (previous > 0.0f && current <= 0.0f);
+            previous = current;
+
+            if (crossed)
+            {
+                const auto rms = rmsAt(i);
+                if (rms >= minimumRms)
+                    startPoints.push_back({ i, rms });
+            }
+        }
+
+        if (startPoints.size() > maxPoints)
+        {
+            std::vector<StartPoint> thinned;
+            thinned.reserve(maxPoints);
+            for (size_t k = 0; k < maxPoints; ++k)
+                thinned.push_back(startPoints[k * startPoints.size() / maxPoints]);
+            startPoints = std::move(thinned);
+        }
+
+        size_t count = 0;
+        for (int percent = 0; percent <= 100; ++percent)
+        {
+            const auto limit = (double) window * percent / 100.0;
+            while (count < startPoints.size() && startPoints[count].position <= limit)
+                ++count;
+            startPointsWithinPercent[(size_t) percent] = (juce::uint32) count;
+        }
+    }
+
+    int getNumBlocks() const { return (numSamples + blockSize - 1) / blockSize; }
+
+    juce::int32 quantise(float x) const
+    {
+        const auto limit = 1 << (bitsPerSample - 1);
+        return juce::jlimit(-limit, limit - 1, juce::roundToInt(x * (float) limit));
+    }
+
+    /** Block layout: int32 first sample, uint8 delta bit width, then the zigzag-encoded
+        deltas of the remaining samples packed LSB-first at that width. */
+    void compress(const juce::AudioBuffer<float>& audio)
+    {
+        const int numBlocks = getNumBlocks();
+        blockOffsets.resize((size_t) (numChannels * numBlocks));
+        std::vector<juce::uint32> zigzag((size_t) blockSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                const int first = b * blockSize;
+                const int length = juce::jmin(blockSize, numSamples - first);
+
+                blockOffsets[(size_t) (ch * numBlocks + b)] = (juce::uint32) storage.size();
+
+                auto prev = quantise(audio.getSample(ch, first));
+                juce::uint32 maxCode = 0;
+
+                for (int i = 1; i < length; ++i)
+                {
+                    const auto v = quantise(audio.getSample(ch, first + i));
+                    const auto delta = v - prev;
+                    const auto code = ((juce::uint32) delta << 1) ^ (juce::uint32) (delta >> 31);
+                    zigzag[(size_t) i] = code;
+                    maxCode = juce::jmax(maxCode, code);
+                    prev = v;
+                }
+
+                int width = 0;
+                while (width < 32 && (maxCode >> width) != 0)
+                    ++width;
+
+                const auto firstValue = (juce::uint32) quantise(audio.getSample(ch, first));
+                for (int k = 0; k < 4; ++k)
+                    storage.push_back((juce::uint8) ((firstValue >> (8 * k)) & 0xff));
+                storage.push_back((juce::uint8) width);
+
+                juce::uint64 acc = 0;
+                int bits = 0;
+
+                for (int i = 1; i < length; ++i)
+                {
+                    acc |= (juce::uint64) zigzag[(size_t) i] << bits;
+                    bits += width;
+
+                    while (bits >= 8)
+                    {
+                        storage.push_back((juce::uint8) (acc & 0xff));
+                        acc >>= 8;
+                        bits -= 8;
+                    }
+                }
+
+                if (bits > 0)
+                    storage.push_back((juce::uint8) (acc & 0xff));
+            }
+        }
+
+        storage.shrink_to_fit();
+    }
+
+    void decodeBlock(juce::uint32 offset, int length, float* dest) const noexcept
+    {
+        const auto* p = storage.data() + offset;
+
+        juce::uint32 firstBits = (juce::uint32) p[0] | ((juce::uint32) p[1] << 8) | ((juce::uint32) p[2] << 16) | ((juce::uint32) p[3] << 24);
+        auto value = (juce::int32) firstBits;
+        const int width = p[4];
+        p += 5;
+
+        dest[0] = (float) value * scale;
+
+        const juce::uint64 mask = width >= 32 ? 0xffffffffULL : ((1ULL << width) - 1);
+        juce::uint64 acc = 0;
+        int bits = 0;
+
+        for (int i = 1; i < length; ++i)
+        {
+            while (bits < width)
+            {
+                acc |= (juce::uint64) *p++ << bits;
+                bits += 8;
+            }
+
+            const auto code = (juce::uint32) (acc & mask);
+            acc >>= width;
+            bits -= width;
+
+            value += (juce::int32) (code >> 1) ^ -(juce::int32) (code & 1);
+            dest[i] = (float) value * scale;
+        }
+    }
+};
@@ -3,110 +3,447 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_audio_formats/juce_audio_formats.h>
 #include <array>
+#include "SampleBank.h"
+#include "Resampler.h"
+#include "SampleData.h"
+#include "SamplePool.h"
 
-/** Per-key sample data for one layer stack. */
+/** Per-key sample data for one layer stack.
+
+    Note audio lives in the process-wide SamplePool; a layer only holds shared
+    references to it, so copying a layer is cheap and identical stacks loaded by
+    several instances occupy memory once. Under a pool memory budget a zone may be
+    evicted between notes; playing it queues a background reload.
+
+    Stacks may be sparse: each sample is a zone rooted at its own key and spans
+    the keys nearer to it than to any other sample, played back pitched by the
+    key distance. A precomputed key -> zone table makes that one lookup per note. */
 class SampleLayer
 {
 public:
     SampleLayer() = default;
     ~SampleLayer() = default;
 
+    /** How note audio is held in memory. */
+    enum class StorageFormat
+    {
+        automatic,  // int16/int24 matching the source bit depth, float for float sources
+        float32,
+        compressed  // lossless block-compressed integer data
+    };
+
+    void setStorageFormat(StorageFormat newFormat) { storageFormat = newFormat; }
+
+    /** Source samples decoded per chunk by renderNote(); callers provide
+        renderScratchSize floats of scratch space. */
+    static constexpr int decodeChunkSize = 256;
+    static constexpr int renderScratchSize = decodeChunkSize + 2;
+
     bool loadFromFolder(const juce::File& folder, double sampleRate)
     {
         if (!folder.isDirectory())
             return false;
 
-        juce::AudioFormatManager manager;
-        manager.registerBasicFormats();
+        juce::SharedResourcePointer<SamplePool> pool;
+
+        const auto format = storageFormat;
+        const auto cacheDirectory = resampleCacheDirectory;
+        const bool resample = cacheDirectory != juce::File() && sampleRate > 0.0;
+        const auto options = getStorageKey() + (resample ? "@" + juce::String(sampleRate) : juce::String());
+
+        // MIDI note 0 (C-1) to 127 (G9) = 128 notes.
+        // One directory scan resolves both naming schemes (C-1.wav / 000.wav)
+        // instead of probing two paths per note.
+        const auto noteFiles = SampleBank::findNoteFiles(folder);
 
-        // MIDI note 0 (C-1) to 127 (G9) = 128 notes
-        // We'll map to 0-127 for simplicity
         for (int note = 0; note < 128; ++note)
         {
-            // Try common naming: C-1.wav, C#-1.wav, etc.
-            // Or numeric: 000.wav, 001.wav, etc.
-            juce::String noteName = juce::MidiMessage::getMidiNoteName(note, true, true, 4);
-            noteName = noteName.replaceCharacter(' ', '-');
-
-            juce::File wavFile = folder.getChildFile(noteName + ".wav");
-            if (!wavFile.existsAsFile())
+            const auto wavFile = noteFiles[(size_t) note];
+            if (wavFile == juce::File())
             {
-                // Try numeric
-                wavFile = folder.getChildFile(juce::String::formatted("%03d.wav", note));
+                samples[(size_t) note].reset();
+                continue;
             }
 
-            if (wavFile.existsAsFile())
+            // Keyed without reading the file, so each WAV is only read to decode it
+            const auto fingerprint = SampleBank::fingerprint(wavFile);
+
+            // Kept by the pool for reloading after eviction, so everything is captured by value
+            samples[(size_t) note] = pool->getOrCreate(SamplePool::makeKey(wavFile, fingerprint, options),
+                                                       [=]() -> SamplePool::DataPtr
             {
-                std::unique_ptr<juce::AudioFormatReader> reader(manager.createReaderFor(wavFile));
-                if (reader != nullptr)
-                {
-                    juce::AudioBuffer<float> buffer(static_cast<int>(reader->numChannels),
-                                                    static_cast<int>(reader->lengthInSamples));
-                    reader->read(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), 0, buffer.getNumSamples());
+                if (resample)
+                    return loadResampled(note, wavFile, format, cacheDirectory, sampleRate, fingerprint);
 
-                    samples[note] = std::move(buffer);
-                    sampleRates[note] = reader->sampleRate;
-                }
-            }
+                return loadFile(wavFile, format);
+            });
         }
 
+        rebuildKeymap();
         return true;
     }
 
-    float getSample(int note, int sampleIndex, int channel, double targetSampleRate) const
+    /** Loads a whole layer from a packed bank written by RavelandBankTool. The bank is
+        opened and mapped once; every zone's loader shares that mapping, which stays
+        open for reloads until the last of the layer's zones is released. */
+    bool loadFromBank(const juce::File& bankFile)
     {
-        if (note < 0 || note >= 128)
-            return 0.0f;
+        auto opened = std::make_shared<SampleBank>();
+        if (!opened->open(bankFile))
+            return false;
 
-        const auto& buffer = samples[note];
-        if (buffer.getNumSamples() == 0)
-            return 0.0f;
+        const std::shared_ptr<const SampleBank> bank = std::move(opened);
+        juce::SharedResourcePointer<SamplePool> pool;
+        const auto format = storageFormat;
 
-        // Simple linear interpolation for pitch shifting
-        const double sourceRate = sampleRates[note];
-        if (sourceRate <= 0.0)
-            return 0.0f;
+        for (auto& slot : samples)
+            slot.reset();
 
-        const double ratio = sourceRate / targetSampleRate;
-        const double sourcePos = sampleIndex * ratio;
+        for (int i = 0; i < bank->getNumZones(); ++i)
+        {
+            const int note = bank->getZone(i).note;
+            const auto key = SamplePool::makeKey(bankFile, bank->getFingerprint(), getStorageKey() + "#" + juce::String(note));
 
-        const int idx0 = static_cast<int>(sourcePos);
-        const int idx1 = idx0 + 1;
-        const float frac = static_cast<float>(sourcePos - idx0);
+            samples[(size_t) note] = pool->getOrCreate(key, [bank, i, format]
+            {
+                return loadBankZone(*bank, i, format);
+            });
+        }
 
-        if (idx0 >= buffer.getNumSamples())
-            return 0.0f;
+        rebuildKeymap();
+        return true;
+    }
 
-        const float s0 = buffer.getSample(channel % buffer.getNumChannels(), idx0);
-        const float s1 = (idx1 < buffer.getNumSamples()) ? buffer.getSample(channel % buffer.getNumChannels(), idx1) : 0.0f;
+    /** Opt-in pre-conversion: when set, loadFromFolder() resamples every note to the
+        requested rate once and keeps the result in this directory, keyed by the source
+        file's path, size and modification time and the target rate. Pass an invalid
+        File to disable. */
+    void setResampleCacheDirectory(const juce::File& directory) { resampleCacheDirectory = directory; }
 
-        return s0 + frac * (s1 - s0);
+    static juce::File getDefaultResampleCacheDirectory()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("NS Audio").getChildFile("RaveLand").getChildFile("ResampleCache");
     }
 
-    int getLengthInSamples(int note, double targetSampleRate) const
+    /** Playback kernel: adds a note into dest[destStart, destStart + numSamples) starting at
+        sourcePosition (in source samples). Source audio is decoded to float a chunk at a time,
+        then linearly interpolated to the target rate and pitched from the zone root to the played
+        key. Returns false once the note has played out. */
+    bool renderNote(int note, double& sourcePosition, double targetSampleRate, float gain,
+                    juce::AudioBuffer<float>& dest, int destStart, int numSamples, float* scratch) const
     {
-        if (note < 0 || note >= 128)
-            return 0;
+        const auto* slot = getSlot(note);
+        if (slot == nullptr || targetSampleRate <= 0.0)
+            return false;
+
+        // Evicted zones stay silent until the pool has them back
+        slot->touch();
+        const auto* data = slot->get();
+        if (data == nullptr)
+            return false;
+
+        const int length = data->getNumSamples();
+        if (sourcePosition >= length)
+            return false;
+
+        const double increment = data->getSampleRate() / targetSampleRate * keyPitchRatio[(size_t) note];
+
+        // Pre-converted and played at its root key: a plain indexed read, no rate math
+        if (increment == 1.0 && sourcePosition == std::floor(sourcePosition))
+        {
+            const int start = static_cast<int>(sourcePosition);
+            const int total = juce::jmin(numSamples, length - start);
+
+            for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+            {
+                auto* out = dest.getWritePointer(ch, destStart);
+                const int sourceChannel = ch % data->getNumChannels();
+
+                for (int done = 0; done < total; done += decodeChunkSize)
+                {
+                    const int count = juce::jmin(decodeChunkSize, total - done);
+                    data->read(sourceChannel, start + done, count, scratch);
+                    juce::FloatVectorOperations::addWithMultiply(out + done, scratch, gain, count);
+                }
+            }
+
+            sourcePosition += total;
+            return sourcePosition < length;
+        }
+
+        double endPosition = sourcePosition;
+
+        for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+        {
+            auto* out = dest.getWritePointer(ch, destStart);
+            const int sourceChannel = ch % data->getNumChannels();
+            double pos = sourcePosition;
+            int i = 0;
+
+            while (i < numSamples)
+            {
+                const int base = static_cast<int>(pos);
+                if (base >= length)
+                    break;
+
+                const int count = juce::jmin(decodeChunkSize + 1, length - base);
+                data->read(sourceChannel, base, count, scratch);
+                scratch[count] = 0.0f; // interpolate toward silence past the end
+
+                // Stay where both interpolation points are decoded; at the very end run to the last sample
+                const double limit = base + count < length ? (double) (base + count - 1) : (double) length;
+
+                while (i < numSamples && pos < limit)
+                {
+                    const int whole = static_cast<int>(pos);
+                    const float frac = static_cast<float>(pos - whole);
+                    const float s0 = scratch[whole - base];
+                    const float s1 = scratch[whole - base + 1];
+
+                    out[i++] += gain * (s0 + frac * (s1 - s0));
+                    pos += increment;
+                }
+            }
 
-        const auto& buffer = samples[note];
-        if (buffer.getNumSamples() == 0)
+            endPosition = pos;
+        }
+
+        sourcePosition = endPosition;
+        return sourcePosition < length;
+    }
+
+    int getLengthInSamples(int note, double targetSampleRate) const
+    {
+        const auto* data = getData(note);
+        if (data == nullptr)
             return 0;
 
-        const double sourceRate = sampleRates[note];
+        const double sourceRate = data->getSampleRate();
         if (sourceRate <= 0.0)
             return 0;
 
-        return static_cast<int>(buffer.getNumSamples() * (targetSampleRate / sourceRate));
+        return static_cast<int>(data->getNumSamples() * (targetSampleRate / sourceRate) / keyPitchRatio[(size_t) note]);
     }
 
     bool hasNote(int note) const
     {
-        if (note < 0 || note >= 128)
-            return false;
-        return samples[note].getNumSamples() > 0;
+        return getSlot(note) != nullptr;
+    }
+
+    /** A click-free randomised start offset (in source samples) for a note, picked in
+        constant time from the zone's precomputed start point index. */
+    double pickStartPosition(int note, int startRandPercent, juce::Random& random) const
+    {
+        const auto* slot = getSlot(note);
+        if (slot == nullptr)
+            return 0.0;
+
+        // Note-on counts as a use, and is the earliest point to start reloading an evicted zone
+        slot->touch();
+        const auto* data = slot->get();
+        if (data == nullptr || startRandPercent <= 0)
+            return 0.0;
+
+        return (double) data->pickStartPoint(startRandPercent, random);
+    }
+
+    /** The key whose sample plays for a note (equal to the note for fully sampled stacks), or -1. */
+    int getRootNoteFor(int note) const
+    {
+        return note >= 0 && note < 128 ? keyToRoot[(size_t) note] : -1;
+    }
+
+    /** Bytes of resident sample memory referenced by this layer (shared data counts in full). */
+    size_t getMemoryUsage() const
+    {
+        size_t total = 0;
+        for (const auto& slot : samples)
+            if (slot != nullptr && slot->get() != nullptr)
+                total += slot->getSizeInBytes();
+        return total;
     }
 
 private:
-    std::array<juce::AudioBuffer<float>, 128> samples;
-    std::array<double, 128> sampleRates {};
+    std::array<SamplePool::SlotPtr, 128> samples; // indexed by root key; null where a stack has no file
+    std::array<int, 128> keyToRoot = makeEmptyKeymap();
+    std::array<double, 128> keyPitchRatio {};
+    juce::File resampleCacheDirectory;
+    StorageFormat storageFormat { StorageFormat::automatic };
+
+    static std::array<int, 128> makeEmptyKeymap()
+    {
+        std::array<int, 128> map;
+        map.fill(-1);
+        return map;
+    }
+
+    /** Maps every key to the nearest sampled root; on a tie the zone above wins,
+        since pitching a sample down sounds more natural than pitching it up. */
+    void rebuildKeymap()
+    {
+        std::vector<int> roots;
+        for (int note = 0; note < 128; ++note)
+            if (samples[(size_t) note] != nullptr)
+                roots.push_back(note);
+
+        keyToRoot = makeEmptyKeymap();
+        keyPitchRatio.fill(1.0);
+
+        if (roots.empty())
+            return;
+
+        size_t next = 0;
+        for (int key = 0; key < 128; ++key)
+        {
+            while (next < roots.size() && roots[next] < key)
+                ++next;
+
+            int root;
+            if (next == roots.size())
+                root = roots.back();
+            else if (next == 0)
+                root = roots.front();
+            else
+                root = (roots[next] - key <= key - roots[next - 1]) ? roots[next] : roots[next - 1];
+
+            keyToRoot[(size_t) key] = root;
+            keyPitchRatio[(size_t) key] = std::pow(2.0, (key - root) / 12.0);
+        }
+    }
+
+    const SampleSlot* getSlot(int note) const
+    {
+        if (note < 0 || note >= 128 || keyToRoot[(size_t) note] < 0)
+            return nullptr;
+
+        return samples[(size_t) keyToRoot[(size_t) note]].get();
+    }
+
+    /** Resident audio for a note; nullptr when unmapped or currently evicted. */
+    const SampleData* getData(int note) const
+    {
+        const auto* slot = getSlot(note);
+        return slot != nullptr ? slot->get() : nullptr;
+    }
+
+    juce::String getStorageKey() const
+    {
+        return "fmt" + juce::String(static_cast<int>(storageFormat));
+    }
+
+    /** Integer bit depth of a source, or 0 for floating-point data. */
+    static int sourceBitDepth(const juce::AudioFormatReader& reader)
+    {
+        return reader.usesFloatingPointData ? 0 : static_cast<int>(reader.bitsPerSample);
+    }
+
+    static SamplePool::DataPtr encode(const juce::AudioBuffer<float>& audio, double sampleRate, int bitsPerSample,
+                                      StorageFormat format)
+    {
+        SampleData data;
+
+        if (format == StorageFormat::float32 || bitsPerSample <= 0 || bitsPerSample > 24)
+            data = SampleData::create(audio, sampleRate, SampleData::Encoding::float32, 32);
+        else if (format == StorageFormat::compressed)
+            data = SampleData::create(audio, sampleRate, SampleData::Encoding::compressed, bitsPerSample <= 16 ? 16 : 24);
+        else
+            data = SampleData::create(audio, sampleRate, bitsPerSample <= 16 ? SampleData::Encoding::int16 : SampleData::Encoding::int24, bitsPerSample);
+
+        return std::make_shared<const SampleData>(std::move(data));
+    }
+
+    /** Stacks are discovered as *.wav only, so the WAV reader is all loading needs;
+        it is cheap enough to create per call, which keeps loaders self-contained. */
+    static std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& wavFile)
+    {
+        auto stream = wavFile.createInputStream();
+        if (stream == nullptr)
+            return {};
+
+        juce::WavAudioFormat wav;
+        return std::unique_ptr<juce::AudioFormatReader>(wav.createReaderFor(stream.release(), true));
+    }
+
+    static SamplePool::DataPtr loadFile(const juce::File& wavFile, StorageFormat format)
+    {
+        auto reader = createReader(wavFile);
+        if (reader == nullptr)
+            return {};
+
+        juce::AudioBuffer<float> buffer(static_cast<int>(reader->numChannels),
+                                        static_cast<int>(reader->lengthInSamples));
+        reader->read(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), 0, buffer.getNumSamples());
+
+        return encode(buffer, reader->sampleRate, sourceBitDepth(*reader), format);
+    }
+
+    static SamplePool::DataPtr loadBankZone(const SampleBank& bank, int zoneIndex, StorageFormat format)
+    {
+        const auto& zone = bank.getZone(zoneIndex);
+        const auto length = static_cast<int>(zone.lengthInSamples);
+
+        juce::AudioBuffer<float> buffer(zone.numChannels, length);
+        for (int ch = 0; ch < zone.numChannels; ++ch)
+            buffer.copyFrom(ch, 0, bank.getChannelData(zoneIndex, ch), length);
+
+        return encode(buffer, zone.sampleRate, zone.sourceBitsPerSample, format);
+    }
+
+    /** Resampled audio is no longer on the source's integer grid; 24 bits keeps the
+        requantisation error far below audibility for any integer source. */
+    static int resampledBitDepth(int sourceBits)
+    {
+        return sourceBits > 0 ? 24 : 0;
+    }
+
+    static SamplePool::DataPtr loadResampled(int note, const juce::File& wavFile, StorageFormat format,
+                                             const juce::File& cacheDirectory, double targetRate, juce::uint64 fingerprint)
+    {
+        const auto cacheFile = cacheDirectory.getChildFile(juce::String::toHexString((juce::int64) fingerprint).paddedLeft('0', 16)
+                                                           + "-" + juce::String(juce::roundToInt(targetRate))
+                                                           + SampleBank::fileExtension);
+
+        SampleBank cached;
+        if (cached.open(cacheFile) && cached.getNumZones() == 1 && cached.getZone(0).sampleRate == targetRate)
+        {
+            const auto& zone = cached.getZone(0);
+            const auto length = static_cast<int>(zone.lengthInSamples);
+
+            juce::AudioBuffer<float> buffer(zone.numChannels, length);
+            for (int ch = 0; ch < zone.numChannels; ++ch)
+                buffer.copyFrom(ch, 0, cached.getChannelData(0, ch), length);
+
+            return encode(buffer, targetRate, resampledBitDepth(zone.sourceBitsPerSample), format);
+        }
+
+        auto reader = createReader(wavFile);
+        if (reader == nullptr)
+            return {};
+
+        juce::AudioBuffer<float> buffer(static_cast<int>(reader->numChannels),
+                                        static_cast<int>(reader->lengthInSamples));
+        reader->read(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), 0, buffer.getNumSamples());
+
+        if (reader->sampleRate == targetRate)
+            return encode(buffer, targetRate, sourceBitDepth(*reader), format);
+
+        SampleBank::Zone zone;
+        zone.note = note;
+        zone.sampleRate = targetRate;
+        zone.sourceBitsPerSample = sourceBitDepth(*reader);
+        zone.audio = Resampler::process(buffer, reader->sampleRate, targetRate);
+
+        auto result = encode(zone.audio, targetRate, resampledBitDepth(zone.sourceBitsPerSample), format);
+
+        // A failed cache write only costs the conversion again next session
+        if (cacheDirectory.createDirectory().wasOk())
+        {
+            std::vector<SampleBank::Zone> entry;
+            entry.push_back(std::move(zone));
+            SampleBank::write(cacheFile, std::move(entry));
+        }
+
+        return result;
+    }
 };
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "SampleBank.h"
+#include "SampleData.h"
+#include "TraceRecorder.h"
+
+/** One pooled zone: immutable note audio that can be evicted under memory
+    pressure and reloaded on demand.
+
+    The audio thread only ever reads the raw data pointer (once per block) and
+    touches atomics; ownership changes happen on the pool thread, and evicted
+    audio is kept alive for a grace period before it is freed. Slots wake the
+    pool thread when they need a reload or go away, so it sleeps while idle. */
+class SampleSlot
+{
+public:
+    using DataPtr = std::shared_ptr<const SampleData>;
+    using Loader = std::function<DataPtr()>;
+
+    SampleSlot(DataPtr initialData, Loader loaderToUse, std::shared_ptr<juce::WaitableEvent> poolWakeUp)
+        : owner(std::move(initialData)), loader(std::move(loaderToUse)), wakeUp(std::move(poolWakeUp))
+    {
+        bytes = owner->getSizeInBytes();
+        data.store(owner.get());
+        lastUsed.store(juce::Time::getMillisecondCounter());
+    }
+
+    /** Released stacks change the resident total, so the pool recounts. */
+    ~SampleSlot()
+    {
+        wakeUp->signal();
+    }
+
+    /** The resident audio, or nullptr while evicted. Safe on the audio thread;
+        the pointer stays valid for the rest of the block even if evicted meanwhile. */
+    const SampleData* get() const noexcept         { return data.load(std::memory_order_acquire); }
+
+    /** Records a use for LRU ordering and asks for a reload if evicted. Audio-thread safe:
+        only the first touch of an evicted zone signals the pool thread. */
+    void touch() const noexcept
+    {
+        lastUsed.store(juce::Time::getMillisecondCounter(), std::memory_order_relaxed);
+
+        if (data.load(std::memory_order_relaxed) == nullptr
+             && !reloadRequested.exchange(true, std::memory_order_relaxed))
+            wakeUp->signal();
+    }
+
+    size_t getSizeInBytes() const noexcept         { return bytes; }
+
+private:
+    friend class SamplePool;
+
+    mutable std::atomic<const SampleData*> data { nullptr };
+    DataPtr owner;       // pool thread only once constructed
+    Loader loader;
+    std::shared_ptr<juce::WaitableEvent> wakeUp; // shared, so a slot can outlive the pool
+    size_t bytes { 0 };
+    mutable std::atomic<juce::uint32> lastUsed { 0 };
+    mutable std::atomic<bool> reloadRequested { false };
+
+    JUCE_DECLARE_NON_COPYABLE(SampleSlot)
+};
+
+//==============================================================================
+/** Process-wide pool of immutable note audio shared by every plugin instance.
+
+    Entries are keyed by source file path plus its size and modification time (plus
+    whatever load options change the decoded result), and held weakly: the pool never keeps
+    audio alive on its own, so memory is released as soon as the last layer using
+    it is unloaded. Loading a stack that another instance already holds only
+    costs the lookups.
+
+    An optional memory budget makes the pool thread evict the least recently
+    played zones until the resident total fits; evicted zones reload in the
+    background the next time they're played.
+
+    Hold it through juce::SharedResourcePointer<SamplePool>. */
+class SamplePool : private juce::Thread
+{
+public:
+    using DataPtr = SampleSlot::DataPtr;
+    using SlotPtr = std::shared_ptr<SampleSlot>;
+
+    struct Stats
+    {
+        juce::int64 residentBytes { 0 };
+        juce::int64 budgetBytes { 0 };   // 0 = unlimited
+        int evictions { 0 };
+        int reloads { 0 };
+        double lastReloadMs { 0.0 };
+        double averageReloadMs { 0.0 };
+    };
+
+    SamplePool() : juce::Thread("RaveLand Sample Pool")
+    {
+        startThread();
+    }
+
+    ~SamplePool() override
+    {
+        signalThreadShouldExit();
+        wakeUp->signal();
+        stopThread(2000);
+    }
+
+    /** Returns the live slot for key, or runs loader to build one and shares it.
+        The loader is kept for reloads after eviction, so it must capture by value.
+        It runs without the pool lock held, so slow loads don't block other instances. */
+    SlotPtr getOrCreate(const juce::String& key, SampleSlot::Loader loader)
+    {
+        {
+            const std::lock_guard<std::mutex> sl(lock);
+            auto it = entries.find(key);
+            if (it != entries.end())
+            {
+                if (auto existing = it->second.lock())
+                {
+                    existing->touch(); // queues a reload if it was evicted
+                    return existing;
+                }
+            }
+        }
+
+        DataPtr created;
+        {
+            RAVELAND_TRACE_SCOPE("sample load");
+            created = loader();
+        }
+
+        if (created == nullptr || created->isEmpty())
+            return {};
+
+        auto slot = std::make_shared<SampleSlot>(std::move(created), std::move(loader), wakeUp);
+
+        {
+            const std::lock_guard<std::mutex> sl(lock);
+            auto& entry = entries[key];
+
+            // Another instance may have finished the same load while we were decoding
+            if (auto existing = entry.lock())
+                return existing;
+
+            entry = slot;
+            pruneExpired();
+        }
+
+        wakeUp->signal();
+        return slot;
+    }
+
+    /** Builds the pool key for one zone of a source file. */
+    static juce::String makeKey(const juce::File& file, juce::uint64 fingerprint, const juce::String& options)
+    {
+        return file.getFullPathName() + "|" + juce::String::toHexString((juce::int64) fingerprint) + "|" + options;
+    }
+
+    /** Caps resident sample memory for the whole process; 0 removes the cap. */
+    void setMemoryBudget(juce::int64 bytes)
+    {
+        budgetBytes.store(juce::jmax((juce::int64) 0, bytes));
+        wakeUp->signal();
+    }
+
+    Stats getStats() const
+    {
+        Stats s;
+        s.residentBytes = residentBytes.load();
+        s.budgetBytes = budgetBytes.load();
+        s.evictions = evictions.load();
+        s.reloads = reloads.load();
+        s.lastReloadMs = lastReloadMs.load();
+        s.averageReloadMs = averageReloadMs.load();
+        return s;
+    }
+
+private:
+    struct Retired
+    {
+        juce::uint32 time;
+        DataPtr data;
+    };
+
+    /** Zones played this recently are treated as in use and never evicted. */
+    static constexpr juce::uint32 inUseMs = 1000;
+
+    /** How long evicted audio outlives its last possible audio-thread reader. */
+    static constexpr juce::uint32 retireGraceMs = 1000;
+
+    std::shared_ptr<juce::WaitableEvent> wakeUp { std::make_shared<juce::WaitableEvent>() };
+    std::mutex lock;
+    std::map<juce::String, std::weak_ptr<SampleSlot>> entries;
+    std::vector<Retired> retired; // pool thread only
+
+    std::atomic<juce::int64> residentBytes { 0 };
+    std::atomic<juce::int64> budgetBytes { 0 };
+    std::atomic<int> evictions { 0 };
+    std::atomic<int> reloads { 0 };
+    std::atomic<double> lastReloadMs { 0.0 };
+    std::atomic<double> averageReloadMs { 0.0 };
+
+    void pruneExpired()
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->second.expired())
+                it = entries.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    std::vector<SlotPtr> getLiveSlots()
+    {
+        std::vector<SlotPtr> slots;
+        const std::lock_guard<std::mutex> sl(lock);
+
+        for (auto& entry : entries)
+            if (auto slot = entry.second.lock())
+                slots.push_back(std::move(slot));
+
+        return slots;
+    }
+
+    void run() override
+    {
+        int timeoutMs = 0;
+
+        while (!threadShouldExit())
+        {
+            // Asleep until a slot, a load or the budget changes; only zones too recently
+            // played to evict and audio waiting out its grace period need a timed wake
+            wakeUp->wait(timeoutMs);
+
+            auto slots = getLiveSlots();
+            serviceReloads(slots);
+            const bool overBudget = enforceBudget(slots);
+            freeRetired();
+
+            juce::int64 resident = 0;
+            for (auto& slot : slots)
+                if (slot->get() != nullptr)
+                    resident += (juce::int64) slot->getSizeInBytes();
+
+            residentBytes.store(resident);
+
+            timeoutMs = overBudget ? (int) inUseMs
+                      : !retired.empty() ? (int) retireGraceMs
+                      : -1;
+        }
+    }
+
+    void serviceReloads(std::vector<SlotPtr>& slots)
+    {
+        for (auto& slot : slots)
+        {
+            if (threadShouldExit())
+                return;
+
+            if (!slot->reloadRequested.exchange(false) || slot->get() != nullptr)
+                continue;
+
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            DataPtr reloaded;
+            {
+                RAVELAND_TRACE_SCOPE("sample reload");
+                reloaded = slot->loader();
+            }
+
+            if (reloaded == nullptr || reloaded->isEmpty())
+                continue;
+
+            slot->owner = std::move(reloaded);
+            slot->data.store(slot->owner.get(), std::memory_order_release);
+
+            const auto elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+            const auto count = reloads.fetch_add(1) + 1;
+            lastReloadMs.store(elapsed);
+            averageReloadMs.store(averageReloadMs.load() + (elapsed - averageReloadMs.load()) / count);
+        }
+    }
+
+    /** Returns true if the zones still resident are over budget. */
+    bool enforceBudget(std::vector<SlotPtr>& slots)
+    {
+        const auto budget = budgetBytes.load();
+        if (budget <= 0)
+            return false;
+
+        juce::int64 resident = 0;
+        for (auto& slot : slots)
+            if (slot->get() != nullptr)
+                resident += (juce::int64) slot->getSizeInBytes();
+
+        if (resident <= budget)
+            return false;
+
+        const auto now = juce::Time::getMillisecondCounter();
+        std::vector<SampleSlot*> candidates;
+
+        for (auto& slot : slots)
+            if (slot->get() != nullptr && now - slot->lastUsed.load(std::memory_order_relaxed) > inUseMs)
+                candidates.push_back(slot.get());
+
+        std::sort(candidates.begin(), candidates.end(), [now] (const SampleSlot* a, const SampleSlot* b)
+        {
+            return now - a->lastUsed.load(std::memory_order_relaxed) > now - b->lastUsed.load(std::memory_order_relaxed);
+        });
+
+        for (auto* slot : candidates)
+        {
+            if (resident <= budget)
+                break;
+
+            slot->data.store(nullptr, std::memory_order_release);
+            retired.push_back({ now, std::move(slot->owner) });
+            resident -= (juce::int64) slot->getSizeInBytes();
+            evictions.fetch_add(1);
+        }
+
+        return resident > budget;
+    }
+
+    void freeRetired()
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                     [now] (const Retired& r) { return now - r.time > retireGraceMs; }),
+                      retired.end());
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(SamplePool)
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <limits>
+
+/** Oscilloscope feed from the audio thread to one editor display.
+
+    The audio thread folds every few samples into a min/max pair, at about 12 kHz
+    whatever the sample rate, and pushes the pairs into a single-producer,
+    single-consumer FIFO. It never waits or allocates: if the editor falls behind,
+    new pairs are dropped. Per sample that's two comparisons and a counter, and
+    nothing at all while no display is watching.
+
+    The editor drains the FIFO into a history on its timer and asks for a window
+    that starts at a rising zero crossing, so a steady waveform stands still. */
+class ScopeCapture
+{
+public:
+    struct Peak
+    {
+        float min { 0.0f };
+        float max { 0.0f };
+    };
+
+    static constexpr double pairRate = 12000.0;
+
+    /** Audio thread stopped. */
+    void prepare(double sampleRate)
+    {
+        decimation = juce::jmax(1, juce::roundToInt(sampleRate / pairRate));
+        startPair();
+    }
+
+    /** Message thread: a display turns capture on while it's showing. */
+    void setActive(bool shouldCapture) noexcept   { active.store(shouldCapture, std::memory_order_relaxed); }
+    bool isActive() const noexcept                { return active.load(std::memory_order_relaxed); }
+
+    /** Audio thread. right may be null for a mono source; a stereo one shows its mid. */
+    void push(const float* left, const float* right, int numSamples) noexcept
+    {
+        if (!isActive())
+            return;
+
+        if (right != nullptr)
+            for (int i = 0; i < numSamples; ++i)
+                add(0.5f * (left[i] + right[i]));
+        else
+            for (int i = 0; i < numSamples; ++i)
+                add(left[i]);
+
+        flush();
+    }
+
+    /** Audio thread: a block that rendered nothing, so the display falls flat. */
+    void pushSilence(int numSamples) noexcept
+    {
+        if (!isActive())
+            return;
+
+        for (int i = 0; i < numSamples; ++i)
+            add(0.0f);
+
+        flush();
+    }
+
+    /** Message thread: moves what the audio thread produced into the history.
+        Returns false if nothing new arrived. */
+    bool update()
+    {
+        const int ready = fifo.getNumReady();
+        if (ready == 0)
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(ready, start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            addToHistory(ring[(size_t) (start1 + i)]);
+        for (int i = 0; i < size2; ++i)
+            addToHistory(ring[(size_t) (start2 + i)]);
+
+        fifo.finishedRead(size1 + size2);
+        return true;
+    }
+
+    /** Message thread: the newest numPairs pairs, moved back to start at the latest rising
+        zero crossing that still leaves a full window, or free-running if there is none. */
+    void getTriggeredWindow(Peak* window, int numPairs) const
+    {
+        numPairs = juce::jlimit(1, historySize / 2, numPairs);
+
+        // Newest possible start first, so the trace lags the audio as little as possible
+        const int newestStart = historyWrite - numPairs;
+        int start = newestStart;
+
+        for (int s = newestStart; s > newestStart - historySize / 2; --s)
+        {
+            const float before = getMid(s - 1);
+            if (before < -triggerHysteresis && getMid(s) >= 0.0f)
+            {
+                start = s;
+                break;
+            }
+        }
+
+        for (int i = 0; i < numPairs; ++i)
+            window[i] = history[(size_t) ((start + i) & (historySize - 1))];
+    }
+
+private:
+    static constexpr int capacity = 4096;         // pairs in flight, about a third of a second
+    static constexpr int historySize = 4096;      // pairs kept by the editor, a power of two
+    static constexpr int batchSize = 64;
+    static constexpr float triggerHysteresis = 1.0e-3f;
+
+    // Audio thread
+    int decimation { 4 };
+    int count { 0 };
+    float low { 0.0f }, high { 0.0f };
+    std::array<Peak, batchSize> batch;
+    int numBatched { 0 };
+
+    // Shared
+    std::atomic<bool> active { false };
+    juce::AbstractFifo fifo { capacity };
+    std::array<Peak, capacity> ring;
+
+    // Message thread
+    std::array<Peak, historySize> history {};
+    int historyWrite { 0 };
+
+    void startPair() noexcept
+    {
+        count = 0;
+        low = std::numeric_limits<float>::max();
+        high = std::numeric_limits<float>::lowest();
+    }
+
+    void add(float x) noexcept
+    {
+        low = x < low ? x : low;
+        high = x > high ? x : high;
+
+        if (++count == decimation)
+        {
+            batch[(size_t) numBatched] = { low, high };
+            startPair();
+
+            if (++numBatched == batchSize)
+                flush();
+        }
+    }
+
+    void flush() noexcept
+    {
+        if (numBatched == 0)
+            return;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numBatched, start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            ring[(size_t) (start1 + i)] = batch[(size_t) i];
+        for (int i = 0; i < size2; ++i)
+            ring[(size_t) (start2 + i)] = batch[(size_t) (size1 + i)];
+
+        fifo.finishedWrite(size1 + size2);
+        numBatched = 0;
+    }
+
+    void addToHistory(const Peak& peak) noexcept
+    {
+        history[(size_t) (historyWrite & (historySize - 1))] = peak;
+        historyWrite = (historyWrite + 1) & (historySize - 1);
+    }
+
+    float getMid(int index) const noexcept
+    {
+        const auto& peak = history[(size_t) (index & (historySize - 1))];
+        return 0.5f * (peak.min + peak.max);
+    }
+};
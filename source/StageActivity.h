@@ -0,0 +1,90 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/** Decides when an FX stage may sleep.
+
+    A stage wakes as soon as its input carries signal, and goes back to sleep once
+    its input is silent and its output has stayed below the threshold for longer
+    than the stage's longest internal gap (the delay time for an echo, say), so a
+    quiet stretch between repeats is not mistaken for a finished tail. */
+class StageActivity
+{
+public:
+    /** About -100 dBFS. */
+    static constexpr float silenceThreshold = 1.0e-5f;
+
+    static bool isSilent(const juce::AudioBuffer<float>& buffer)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            if (buffer.getMagnitude(ch, 0, buffer.getNumSamples()) >= silenceThreshold)
+                return false;
+
+        return true;
+    }
+
+    void setHoldSamples(int samples) { holdSamples = samples; }
+
+    /** Call before the stage runs with whether its settings make it audible at all.
+        Returns false when the stage can be skipped for this block. */
+    bool begin(const juce::AudioBuffer<float>& input, bool enabled)
+    {
+        resetNeeded = false;
+
+        if (!enabled)
+        {
+            disable();
+            return false;
+        }
+
+        inputSilent = isSilent(input);
+
+        if (!inputSilent && !awake)
+        {
+            awake = true;
+            resetNeeded = stale;
+            stale = false;
+        }
+
+        return awake;
+    }
+
+    /** Puts the stage to sleep because it was switched off. Whatever it still holds
+        mid-tail must not replay when it comes back. */
+    void disable()
+    {
+        stale = stale || awake;
+        awake = false;
+        silentSamples = 0;
+    }
+
+    /** Call after the stage ran, with its output. */
+    void end(const juce::AudioBuffer<float>& output)
+    {
+        if (!inputSilent || !isSilent(output))
+        {
+            silentSamples = 0;
+            return;
+        }
+
+        silentSamples += output.getNumSamples();
+        if (silentSamples > holdSamples)
+        {
+            awake = false;
+            silentSamples = 0;
+        }
+    }
+
+    /** True when the stage wakes after being switched off mid-tail, so it should
+        clear its state. A stage that slept through silence has nothing left to clear. */
+    bool needsReset() const noexcept { return resetNeeded; }
+    bool isAwake() const noexcept  { return awake; }
+
+private:
+    int holdSamples { 0 };
+    int silentSamples { 0 };
+    bool awake { false };
+    bool stale { false };
+    bool resetNeeded { false };
+    bool inputSilent { true };
+};
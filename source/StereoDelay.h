@@ -0,0 +1,169 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cmath>
+
+/** Block-processed feedback delay.
+
+    The circular buffer is sized from the session sample rate in prepare(), so the
+    full delay range is available at any rate. Delay time is fractional and glides
+    to new targets; while it holds still, each span of the block is read with one
+    linear-interpolating vector mix and written back with one vector mix. */
+class StereoDelay
+{
+public:
+    /** Longest delay the buffer holds: a whole note at 60 BPM. */
+    static constexpr double maxDelaySeconds = 4.0;
+
+    /** Tempo-synced divisions, in quarter notes. Names match the delaySyncDiv parameter. */
+    static juce::StringArray getSyncDivisionNames()
+    {
+        return { "1/32", "1/16T", "1/16", "1/16D", "1/8T", "1/8", "1/8D", "1/4T", "1/4", "1/4D", "1/2", "1/1" };
+    }
+
+    static double getSyncDivisionBeats(int index)
+    {
+        static constexpr double beats[] = { 0.125, 1.0 / 6.0, 0.25, 0.375, 1.0 / 3.0, 0.5, 0.75, 2.0 / 3.0, 1.0, 1.5, 2.0, 4.0 };
+        return beats[juce::jlimit(0, (int) std::size(beats) - 1, index)];
+    }
+
+    void prepare(double newSampleRate, int maxBlockSize, int numChannels)
+    {
+        sampleRate = newSampleRate;
+        bufferLength = (int) std::ceil(maxDelaySeconds * sampleRate) + maxBlockSize + 2;
+
+        lines.setSize(numChannels, bufferLength);
+        wet.setSize(numChannels, maxBlockSize);
+        scratch.setSize(1, maxBlockSize + 1);
+
+        delaySamples.reset(sampleRate, 0.08);
+        delaySamples.setCurrentAndTargetValue(clampDelay(delaySamples.getTargetValue()));
+        reset();
+    }
+
+    void reset()
+    {
+        lines.clear();
+        writePosition = 0;
+        delaySamples.setCurrentAndTargetValue(delaySamples.getTargetValue());
+    }
+
+    void setDelayTimeMs(float milliseconds)
+    {
+        delaySamples.setTargetValue(clampDelay((float) (sampleRate * milliseconds / 1000.0)));
+    }
+
+    void setFeedback(float newFeedback) { feedback = newFeedback; }
+    void setMix(float newMix)           { mix = newMix; }
+
+    void process(juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        const int numChannels = juce::jmin(buffer.getNumChannels(), lines.getNumChannels());
+        int done = 0;
+
+        while (done < numSamples)
+        {
+            // Every read in a span must land on samples written before the span starts
+            const float shortest = juce::jmin(delaySamples.getCurrentValue(), delaySamples.getTargetValue());
+            const int span = juce::jmin(numSamples - done, juce::jmax(1, (int) shortest - 1));
+
+            if (delaySamples.isSmoothing())
+                readGliding(numChannels, done, span);
+            else
+                readFixed(numChannels, done, span, delaySamples.getCurrentValue());
+
+            // Feed the input plus the regenerated echo back into the line
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto* in = buffer.getReadPointer(ch, done);
+                const auto* echo = wet.getReadPointer(ch, done);
+                auto* line = lines.getWritePointer(ch);
+
+                const int first = juce::jmin(span, bufferLength - writePosition);
+                juce::FloatVectorOperations::copy(line + writePosition, in, first);
+                juce::FloatVectorOperations::addWithMultiply(line + writePosition, echo, feedback, first);
+
+                if (first < span)
+                {
+                    juce::FloatVectorOperations::copy(line, in + first, span - first);
+                    juce::FloatVectorOperations::addWithMultiply(line, echo + first, feedback, span - first);
+                }
+            }
+
+            writePosition = (writePosition + span) % bufferLength;
+            done += span;
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer.applyGain(ch, 0, numSamples, 1.0f - mix);
+            buffer.addFrom(ch, 0, wet, ch, 0, numSamples, mix);
+        }
+    }
+
+private:
+    double sampleRate { 44100.0 };
+    int bufferLength { 0 };
+    int writePosition { 0 };
+    float feedback { 0.3f };
+    float mix { 0.18f };
+
+    juce::AudioBuffer<float> lines;
+    juce::AudioBuffer<float> wet;
+    juce::AudioBuffer<float> scratch;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> delaySamples { 2.0f };
+
+    float clampDelay(float samples) const
+    {
+        return juce::jlimit(2.0f, (float) (maxDelaySeconds * sampleRate), samples);
+    }
+
+    int wrap(int index) const
+    {
+        index %= bufferLength;
+        return index < 0 ? index + bufferLength : index;
+    }
+
+    /** Constant delay: gather span + 1 contiguous samples, then interpolate with two vector mixes. */
+    void readFixed(int numChannels, int offset, int span, float delay)
+    {
+        const double readPosition = writePosition - (double) delay;
+        const double whole = std::floor(readPosition);
+        const float frac = (float) (readPosition - whole);
+        const int start = wrap((int) whole);
+        const int count = span + 1;
+        auto* gathered = scratch.getWritePointer(0);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* line = lines.getReadPointer(ch);
+            const int first = juce::jmin(count, bufferLength - start);
+            juce::FloatVectorOperations::copy(gathered, line + start, first);
+            if (first < count)
+                juce::FloatVectorOperations::copy(gathered + first, line, count - first);
+
+            auto* out = wet.getWritePointer(ch, offset);
+            juce::FloatVectorOperations::copyWithMultiply(out, gathered, 1.0f - frac, span);
+            juce::FloatVectorOperations::addWithMultiply(out, gathered + 1, frac, span);
+        }
+    }
+
+    /** Delay time gliding: per-sample read position, so the pitch bends instead of clicking. */
+    void readGliding(int numChannels, int offset, int span)
+    {
+        for (int i = 0; i < span; ++i)
+        {
+            const double readPosition = writePosition + i - (double) delaySamples.getNextValue();
+            const double whole = std::floor(readPosition);
+            const float frac = (float) (readPosition - whole);
+            const int i0 = wrap((int) whole);
+            const int i1 = i0 + 1 < bufferLength ? i0 + 1 : 0;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto* line = lines.getReadPointer(ch);
+                wet.setSample(ch, offset + i, line[i0] + frac * (line[i1] - line[i0]));
+            }
+        }
+    }
+};
@@ -2,18 +2,20 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include "DspKernels.h"
+#include "SampleLayer.h"
+#include "TraceRecorder.h"
 
 /** Simple supersaw-style oscillator used per voice.
-    This is deliberately lightweight to be realistic for a small team. */
+    This is deliberately lightweight to be realistic for a small team.
+    The unison sum runs in DspKernels, a block at a time, at the CPU's widest vector width. */
 class SupersawOsc
 {
 public:
     void prepare(double sampleRate)
     {
         sr = sampleRate;
-        phaseBase = 0.0;
-        for (auto& p : detunedPhase)
-            p = 0.0;
+        detunedPhase.fill(0.0);
     }
 
     void setFrequency(float hz) { freq = hz; }
@@ -21,37 +23,34 @@ public:
     void setNumVoices(int voices) { numVoices = juce::jlimit(1, maxVoices, voices); }
     void setGain(float g) { gain = g; }
 
-    float processSample()
+    void renderBlock(float* output, int numSamples)
     {
         if (sr <= 0.0)
-            return 0.0f;
+        {
+            juce::FloatVectorOperations::clear(output, numSamples);
+            return;
+        }
 
         const double baseInc = (2.0 * juce::MathConstants<double>::pi * freq) / sr;
         const double maxSpread = 0.012; // modest spread to keep in tune
         const double spread = (detuneCents / 100.0) * maxSpread;
 
-        float acc = 0.0f;
         for (int i = 0; i < numVoices; ++i)
         {
-            const double offset = spread * ((double) i / (numVoices - 1) - 0.5);
-            detunedPhase[i] += baseInc * (1.0 + offset);
-            if (detunedPhase[i] > 2.0 * juce::MathConstants<double>::pi)
-                detunedPhase[i] -= 2.0 * juce::MathConstants<double>::pi;
-
-            const float s = std::sin((float) detunedPhase[i]);
-            acc += s;
+            const double offset = numVoices > 1 ? spread * ((double) i / (numVoices - 1) - 0.5) : 0.0;
+            increments[(size_t) i] = baseInc * (1.0 + offset);
         }
 
-        const float norm = 1.0f / (float) numVoices;
-        return acc * norm * gain;
+        DspKernels::get().supersaw(detunedPhase.data(), increments.data(), numVoices,
+                                   gain / (float) numVoices, output, numSamples);
     }
 
 private:
     static constexpr int maxVoices = 32;
 
     double sr { 0.0 };
-    double phaseBase { 0.0 };
     std::array<double, maxVoices> detunedPhase {};
+    std::array<double, maxVoices> increments {};
 
     float freq { 440.0f };
     float detuneCents { 0.0f };
@@ -59,16 +58,32 @@ private:
     float gain { 0.7f };
 };
 
-/** One synth voice that mixes sampled layer stubs and a supersaw oscillator.
-    For now, the "sample layers" are placeholders (no file I/O) but the architecture
-    is in place to hook up your per-key WAV stacks later. */
+/** One synth voice that mixes the per-key sample layers and a supersaw oscillator. */
 class RavelandVoice : public juce::SynthesiserVoice
 {
 public:
+    /** Points the voice at the processor's layer stacks and their per-block enable/gain/start state. */
+    void setSampleLayers(const std::array<SampleLayer, 3>* layers,
+                         const std::array<bool, 3>* enabled,
+                         const std::array<float, 3>* gains,
+                         const std::array<int, 3>* startRand)
+    {
+        sampleLayers = layers;
+        layerEnabled = enabled;
+        layerGain = gains;
+        layerStartRand = startRand;
+    }
+
+    /** Points the voice at the processor's scope buses: the oscillator, then each layer.
+        Null entries aren't being watched. */
+    void setScopeBuses(const std::array<float*, 4>* buses) { scopeBuses = buses; }
+
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
         (void) spec;
         osc.prepare(spec.sampleRate);
+        layerTemp.setSize(2, (int) spec.maximumBlockSize);
+        scopeEnvelope.assign(spec.maximumBlockSize, 0.0f);
         adsr.setSampleRate(spec.sampleRate);
 
         juce::ADSR::Parameters p;
@@ -89,6 +104,14 @@ public:
         auto freq = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
         osc.setFrequency(freq);
         currentVelocity = velocity;
+
+        for (size_t i = 0; i < layerPlaying.size(); ++i)
+        {
+            layerPlaying[i] = sampleLayers != nullptr && (*layerEnabled)[i] && (*sampleLayers)[i].hasNote(midiNoteNumber);
+            layerPosition[i] = layerPlaying[i] ? (*sampleLayers)[i].pickStartPosition(midiNoteNumber, (*layerStartRand)[i], random)
+                                               : 0.0;
+        }
+
         adsr.noteOn();
     }
 
@@ -98,11 +121,18 @@ public:
             adsr.noteOff();
         else
         {
+            // The synthesiser cuts a sounding note dead when it steals the voice
+            if (adsr.isActive())
+                ++steals;
+
             clearCurrentNote();
             adsr.reset();
         }
     }
 
+    /** Notes cut off while sounding since the last call, i.e. voice steals. */
+    int takeSteals() noexcept { return std::exchange(steals, 0); }
+
     void pitchWheelMoved(int) override {}
     void controllerMoved(int, int) override {}
 
@@ -111,21 +141,98 @@ public:
         if (! adsr.isActive())
             return;
 
-        temp.setSize(1, numSamples, false, false, true);
+        RAVELAND_TRACE_SCOPE("voice");
+        temp.setSize(2, numSamples, false, false, true);
 
-        for (int i = 0; i < numSamples; ++i)
-            temp.setSample(0, i, osc.processSample() * currentVelocity);
+        osc.renderBlock(temp.getWritePointer(0), numSamples);
+        juce::FloatVectorOperations::multiply(temp.getWritePointer(0), currentVelocity, numSamples);
+
+        // Watched sources go to the scopes after the envelope, taken from a copy of it,
+        // so capturing never changes what the voice plays
+        const bool capture = isAnyScopeWatched() && numSamples <= (int) scopeEnvelope.size();
+        if (capture)
+        {
+            auto envelope = adsr;
+            for (int i = 0; i < numSamples; ++i)
+                scopeEnvelope[(size_t) i] = envelope.getNextSample();
+
+            if (auto* bus = (*scopeBuses)[0])
+                addToScopeBus(bus + startSample, temp.getReadPointer(0), nullptr, numSamples);
+        }
+
+        temp.copyFrom(1, 0, temp, 0, 0, numSamples);
+
+        for (size_t i = 0; i < layerPlaying.size(); ++i)
+        {
+            if (!layerPlaying[i])
+                continue;
+
+            auto* bus = capture ? (*scopeBuses)[i + 1] : nullptr;
+            auto& layerTarget = bus != nullptr ? layerTemp : temp;
+
+            // A watched layer renders on its own first; adding it to silence is exact
+            if (bus != nullptr)
+                layerTemp.clear(0, numSamples);
+
+            layerPlaying[i] = (*sampleLayers)[i].renderNote(getCurrentlyPlayingNote(), layerPosition[i], getSampleRate(),
+                                                            (*layerGain)[i] * currentVelocity,
+                                                            layerTarget, 0, numSamples, decodeScratch.data());
+
+            if (bus != nullptr)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    temp.addFrom(ch, 0, layerTemp, ch, 0, numSamples);
+
+                addToScopeBus(bus + startSample, layerTemp.getReadPointer(0), layerTemp.getReadPointer(1), numSamples);
+            }
+        }
 
         adsr.applyEnvelopeToBuffer(temp, 0, numSamples);
 
         for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
-            outputBuffer.addFrom(ch, startSample, temp, 0, 0, numSamples);
+            outputBuffer.addFrom(ch, startSample, temp, ch % 2, 0, numSamples);
+
+        // Release finished: free the voice so the processor can tell it is idle
+        if (! adsr.isActive())
+            clearCurrentNote();
     }
 
 private:
     SupersawOsc osc;
     juce::ADSR adsr;
     juce::AudioBuffer<float> temp;
+    juce::AudioBuffer<float> layerTemp;
+    std::vector<float> scopeEnvelope;
+    const std::array<float*, 4>* scopeBuses { nullptr };
     float currentVelocity { 0.0f };
+    int steals { 0 };
+
+    const std::array<SampleLayer, 3>* sampleLayers { nullptr };
+    const std::array<bool, 3>* layerEnabled { nullptr };
+    const std::array<float, 3>* layerGain { nullptr };
+    const std::array<int, 3>* layerStartRand { nullptr };
+    juce::Random random;
+    std::array<bool, 3> layerPlaying {};
+    std::array<double, 3> layerPosition {};
+    std::array<float, SampleLayer::renderScratchSize> decodeScratch {};
+
+    bool isAnyScopeWatched() const noexcept
+    {
+        if (scopeBuses == nullptr)
+            return false;
+
+        for (auto* bus : *scopeBuses)
+            if (bus != nullptr)
+                return true;
+
+        return false;
+    }
+
+    /** Adds a source (its mid, if stereo) to a scope bus under the envelope. */
+    void addToScopeBus(float* bus, const float* left, const float* right, int numSamples) const noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            bus[i] += (right != nullptr ? 0.5f * (left[i] + right[i]) : left[i]) * scopeEnvelope[(size_t) i];
+    }
 };
 
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+/** Optional timeline tracing: begin/end events from any thread, written out as Chrome
+    trace-event JSON that chrome://tracing and Perfetto open directly.
+
+    Every buffer is allocated by start(). A thread claims one of them on its first event
+    and from then on recording is a clock read and a store into that buffer: no locks,
+    no allocation. Each buffer is a ring, so a long session keeps its most recent events,
+    usually the ones around the glitch that made you stop. While tracing is off an event
+    costs one relaxed load.
+
+    Event names must be string literals: only the pointer is stored. */
+class TraceRecorder
+{
+public:
+    static TraceRecorder& getInstance()
+    {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    /** Message thread. Allocates the buffers and starts recording. */
+    void start(int eventsPerThread = 1 << 17)
+    {
+        if (isActive())
+            return;
+
+        for (auto& buffer : buffers)
+        {
+            buffer.events.assign((size_t) juce::nextPowerOfTwo(juce::jmax(16, eventsPerThread)), Event());
+            buffer.count.store(0);
+            buffer.threadName[0] = 0;
+        }
+
+        numClaimed.store(0);
+        startTicks = juce::Time::getHighResolutionTicks();
+        generation.fetch_add(1, std::memory_order_release);
+        active.store(true, std::memory_order_release);
+    }
+
+    /** Message thread. Stops recording and writes what was captured; the buffers are kept
+        until the next start(). Returns false if nothing was recording or the file can't
+        be written. */
+    bool stop(const juce::File& output)
+    {
+        if (!active.exchange(false))
+            return false;
+
+        // Let events that passed the check before the switch finish their store
+        juce::Thread::sleep(20);
+
+        juce::MemoryOutputStream json;
+        json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        const double microsPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+        const int claimed = juce::jmin(numClaimed.load(), maxThreads);
+        bool first = true;
+
+        for (int t = 0; t < claimed; ++t)
+        {
+            const auto& buffer = buffers[(size_t) t];
+            const auto tid = juce::String(t + 1);
+
+            json << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                 << ",\"args\":{\"name\":" << juce::JSON::toString(getThreadName(buffer, t)) << "}}";
+            first = false;
+
+            const auto count = buffer.count.load(std::memory_order_acquire);
+            const auto size = (juce::int64) buffer.events.size();
+
+            for (auto i = juce::jmax((juce::int64) 0, count - size); i < count; ++i)
+            {
+                const auto& event = buffer.events[(size_t) (i & (size - 1))];
+                json << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << juce::String::charToString(event.phase)
+                     << "\",\"ts\":" << juce::String((double) (event.ticks - startTicks) * microsPerTick, 3)
+                     << ",\"pid\":1,\"tid\":" << tid << "}";
+            }
+        }
+
+        json << "\n]}\n";
+
+        output.deleteFile();
+        return output.replaceWithData(json.getData(), json.getDataSize());
+    }
+
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+
+    void begin(const char* name) noexcept
+    {
+        if (isActive())
+            record(name, 'B');
+    }
+
+    void end(const char* name) noexcept
+    {
+        if (isActive())
+            record(name, 'E');
+    }
+
+private:
+    TraceRecorder() = default;
+
+    static constexpr int maxThreads = 16;
+
+    struct Event
+    {
+        const char* name { "" };
+        juce::int64 ticks { 0 };
+        char phase { 'B' };
+    };
+
+    struct ThreadBuffer
+    {
+        std::vector<Event> events;
+        std::atomic<juce::int64> count { 0 };
+        char threadName[64] {}; // UTF-8, written by the owning thread without allocating
+    };
+
+    std::array<ThreadBuffer, maxThreads> buffers;
+    std::atomic<int> numClaimed { 0 };
+    std::atomic<int> generation { 0 };
+    std::atomic<bool> active { false };
+    juce::int64 startTicks { 0 };
+
+    void record(const char* name, char phase) noexcept
+    {
+        auto* buffer = getThreadBuffer();
+        if (buffer == nullptr)
+            return;
+
+        // Only the owning thread writes, so a plain read-modify-write of the count is safe
+        const auto index = buffer->count.load(std::memory_order_relaxed);
+        auto& event = buffer->events[(size_t) (index & (juce::int64) (buffer->events.size() - 1))];
+        event.name = name;
+        event.ticks = juce::Time::getHighResolutionTicks();
+        event.phase = phase;
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    /** The calling thread's buffer for this session, claimed on first use. Threads beyond
+        maxThreads go unrecorded. */
+    ThreadBuffer* getThreadBuffer() noexcept
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        thread_local int bufferGeneration = 0;
+
+        const auto current = generation.load(std::memory_order_acquire);
+        if (bufferGeneration != current)
+        {
+            bufferGeneration = current;
+            const int index = numClaimed.fetch_add(1);
+            buffer = index < maxThreads ? &buffers[(size_t) index] : nullptr;
+
+            // Once per thread per session; the name is what the timeline shows
+            if (buffer != nullptr)
+                describeCurrentThread(buffer->threadName, sizeof(buffer->threadName));
+        }
+
+        return buffer;
+    }
+
+    /** Copies the calling thread's name into dest. Runs on the thread itself, possibly the
+        audio thread, so it only copies characters: the name String is shared, not built. */
+    static void describeCurrentThread(char* dest, size_t destSize) noexcept
+    {
+        dest[0] = 0;
+
+        if (auto* thread = juce::Thread::getCurrentThread())
+        {
+            thread->getThreadName().copyToUTF8(dest, destSize);
+            return;
+        }
+
+        static constexpr char messageThreadName[] = "Message Thread";
+
+        if (auto* mm = juce::MessageManager::getInstanceWithoutCreating())
+            if (mm->isThisTheMessageThread() && destSize >= sizeof(messageThreadName))
+                std::memcpy(dest, messageThreadName, sizeof(messageThreadName));
+    }
+
+    /** Message thread, in stop(): the recorded name, or a numbered one for unnamed threads. */
+    static juce::String getThreadName(const ThreadBuffer& buffer, int index)
+    {
+        const juce::String name(juce::CharPointer_UTF8(buffer.threadName));
+        return name.isNotEmpty() ? name : "Thread " + juce::String(index + 1);
+    }
+};
+
+/** Records a begin event now and the matching end event when it goes out of scope. */
+struct TraceScope
+{
+    explicit TraceScope(const char* eventName) noexcept : name(eventName)
+    {
+        TraceRecorder::getInstance().begin(name);
+    }
+
+    ~TraceScope() { TraceRecorder::getInstance().end(name); }
+
+    const char* name;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceScope)
+};
+
+#define RAVELAND_TRACE_SCOPE(eventName) const TraceScope JUCE_JOIN_MACRO(traceScope, __LINE__) (eventName)
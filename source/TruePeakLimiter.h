@@ -0,0 +1,253 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+#include <vector>
+
+/** Lookahead true-peak limiter for the master output.
+
+    Peaks are measured on a 4x upsampled copy of the signal (a polyphase windowed-sinc
+    interpolator; phase 0 is the sample itself), so inter-sample overs are caught
+    before they reach the converter. The gain computer takes the minimum of the
+    required gain over the lookahead window with a monotonic deque (amortised O(1)
+    per sample), lets it recover with a one-pole release, then averages it over the
+    same window with a running sum. The averaged gain is therefore already down to
+    the required value when a peak arrives, and never steps.
+
+    Blocks whose worst possible true peak is below the ceiling skip the interpolator,
+    so the limiter costs little more than its delay line until something gets loud. */
+class TruePeakLimiter
+{
+public:
+    void prepare(double newSampleRate, int maxBlockSize, int numChannels)
+    {
+        sampleRate = newSampleRate;
+        lookahead = juce::jmax(1, (int) std::round(lookaheadMs * 0.001 * sampleRate));
+        releaseCoeff = (float) std::exp(-1.0 / (releaseMs * 0.001 * sampleRate));
+
+        designInterpolator();
+
+        int dequeSize = 1;
+        while (dequeSize <= lookahead + 1)
+            dequeSize <<= 1;
+
+        dequeMask = dequeSize - 1;
+        dequeIndex.assign((size_t) dequeSize, 0);
+        dequeGain.assign((size_t) dequeSize, 1.0f);
+        boxGains.assign((size_t) lookahead, 1.0f);
+
+        channels = juce::jmin(numChannels, maxChannels);
+        delayLength = getLatencySamples() + maxBlockSize;
+        delayLine.setSize(channels, delayLength);
+        gains.resize((size_t) maxBlockSize);
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& h : history)
+            h.fill(0.0f);
+
+        historyWrite = 0;
+        lastIntervalPeak = 0.0f;
+        sampleIndex = 0;
+        dequeHead = dequeTail = 0;
+        std::fill(boxGains.begin(), boxGains.end(), 1.0f);
+        boxSum = (double) lookahead;
+        boxWrite = 0;
+        releasedGain = 1.0f;
+
+        delayLine.clear();
+        delayWrite = 0;
+    }
+
+    /** Output ceiling in dBTP. */
+    void setCeilingDb(float db) { ceiling = juce::Decibels::decibelsToGain(db); }
+
+    /** Lookahead plus the interpolator's own delay. */
+    int getLatencySamples() const { return lookahead + centreTap; }
+
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        const int numSamples = juce::jmin(buffer.getNumSamples(), (int) gains.size());
+        const int numChannels = juce::jmin(buffer.getNumChannels(), channels);
+
+        // The windows measured this block also reach back into the last block's final
+        // samples, whose peaks are only measured now, so those count toward the bound too
+        float blockPeak = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            blockPeak = juce::jmax(blockPeak, buffer.getMagnitude(ch, 0, numSamples));
+
+            const auto& h = history[(size_t) ch];
+            const auto range = juce::FloatVectorOperations::findMinAndMax(h.data(), taps);
+            blockPeak = juce::jmax(blockPeak, -range.getStart(), range.getEnd());
+        }
+
+        const bool belowCeiling = blockPeak * interpolatorGainBound < ceiling;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float intervalPeak = 0.0f;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto& h = history[(size_t) ch];
+                const float x = buffer.getSample(ch, i);
+                h[(size_t) historyWrite] = x;
+                h[(size_t) (historyWrite + taps)] = x;
+
+                if (!belowCeiling)
+                    intervalPeak = juce::jmax(intervalPeak, measureInterval(h.data() + historyWrite + 1));
+            }
+
+            historyWrite = historyWrite + 1 == taps ? 0 : historyWrite + 1;
+
+            // A peak between two samples needs both of them turned down
+            const float peak = juce::jmax(intervalPeak, lastIntervalPeak);
+            lastIntervalPeak = intervalPeak;
+
+            const float required = peak > ceiling ? ceiling / peak : 1.0f;
+            const float held = slidingMinimum(required);
+
+            releasedGain = held < releasedGain ? held : held + releaseCoeff * (releasedGain - held);
+
+            boxSum += (double) (releasedGain - boxGains[(size_t) boxWrite]);
+            boxGains[(size_t) boxWrite] = releasedGain;
+            boxWrite = boxWrite + 1 == lookahead ? 0 : boxWrite + 1;
+
+            gains[(size_t) i] = (float) (boxSum / lookahead);
+        }
+
+        const int latency = getLatencySamples();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* line = delayLine.getWritePointer(ch);
+            auto* data = buffer.getWritePointer(ch);
+
+            const int first = juce::jmin(numSamples, delayLength - delayWrite);
+            juce::FloatVectorOperations::copy(line + delayWrite, data, first);
+            juce::FloatVectorOperations::copy(line, data + first, numSamples - first);
+
+            int read = delayWrite - latency;
+            if (read < 0)
+                read += delayLength;
+
+            const int firstRead = juce::jmin(numSamples, delayLength - read);
+            juce::FloatVectorOperations::multiply(data, line + read, gains.data(), firstRead);
+            juce::FloatVectorOperations::multiply(data + firstRead, line, gains.data() + firstRead, numSamples - firstRead);
+        }
+
+        delayWrite = (delayWrite + numSamples) % delayLength;
+    }
+
+private:
+    static constexpr int maxChannels = 2;
+    static constexpr int oversampling = 4;
+    static constexpr int taps = 12;                 // per phase
+    static constexpr int centreTap = taps / 2 - 1;  // phase 0 reads this tap unchanged
+    static constexpr double lookaheadMs = 1.5;
+    static constexpr double releaseMs = 60.0;
+
+    double sampleRate { 44100.0 };
+    float ceiling { 0.891f }; // -1 dBTP
+
+    // Phases 1..3 of the interpolator, each ordered oldest sample first
+    std::array<std::array<float, taps>, oversampling - 1> phases {};
+    float interpolatorGainBound { 1.0f };
+
+    // Each channel's last `taps` inputs, written twice so any window is contiguous
+    std::array<std::array<float, 2 * taps>, maxChannels> history {};
+    int historyWrite { 0 };
+    int channels { 0 };
+    float lastIntervalPeak { 0.0f };
+
+    int lookahead { 1 };
+    float releaseCoeff { 0.0f };
+    float releasedGain { 1.0f };
+
+    // Monotonic deque of (sample index, gain), increasing gains from head to tail
+    std::vector<juce::int64> dequeIndex;
+    std::vector<float> dequeGain;
+    int dequeMask { 0 };
+    int dequeHead { 0 };
+    int dequeTail { 0 };
+    juce::int64 sampleIndex { 0 };
+
+    std::vector<float> boxGains;
+    double boxSum { 0.0 };
+    int boxWrite { 0 };
+
+    std::vector<float> gains;
+    juce::AudioBuffer<float> delayLine;
+    int delayLength { 0 };
+    int delayWrite { 0 };
+
+    /** Largest magnitude among the window's sample and its three interpolated
+        neighbours, the interval just before it. */
+    float measureInterval(const float* window) const
+    {
+        float peak = std::abs(window[taps - 1 - centreTap]);
+
+        for (const auto& phase : phases)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < taps; ++k)
+                sum += phase[(size_t) k] * window[k];
+
+            peak = juce::jmax(peak, std::abs(sum));
+        }
+
+        return peak;
+    }
+
+    /** Pushes a gain and returns the minimum over the last `lookahead` pushes. */
+    float slidingMinimum(float gain)
+    {
+        while (dequeTail != dequeHead && dequeGain[(size_t) ((dequeTail - 1) & dequeMask)] >= gain)
+            dequeTail = (dequeTail - 1) & dequeMask;
+
+        dequeIndex[(size_t) dequeTail] = sampleIndex;
+        dequeGain[(size_t) dequeTail] = gain;
+        dequeTail = (dequeTail + 1) & dequeMask;
+
+        if (dequeIndex[(size_t) dequeHead] <= sampleIndex - lookahead)
+            dequeHead = (dequeHead + 1) & dequeMask;
+
+        ++sampleIndex;
+        return dequeGain[(size_t) dequeHead];
+    }
+
+    void designInterpolator()
+    {
+        interpolatorGainBound = 1.0f;
+
+        for (int p = 1; p < oversampling; ++p)
+        {
+            auto& phase = phases[(size_t) (p - 1)];
+            double sum = 0.0;
+
+            // Window slot k holds x[n - (taps - 1 - k)]; phase p sits p/4 of a sample before the centre tap
+            for (int k = 0; k < taps; ++k)
+            {
+                const double t = (double) (taps - 1 - k - centreTap) - (double) p / oversampling;
+                const double sinc = juce::MathConstants<double>::pi * t;
+                const double window = 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * t / (taps / 2)));
+                phase[(size_t) k] = (float) (std::sin(sinc) / sinc * window);
+                sum += phase[(size_t) k];
+            }
+
+            float absSum = 0.0f;
+            for (auto& c : phase)
+            {
+                c = (float) (c / sum); // unity gain at DC
+                absSum += std::abs(c);
+            }
+
+            interpolatorGainBound = juce::jmax(interpolatorGainBound, absSum);
+        }
+    }
+};
@@ -1,17 +1,46 @@
 #pragma once
 
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "ScopeCapture.h"
 
 static const juce::Colour waveformAccent = juce::Colour::fromString("0xff00d4ff");
 static const juce::Colour waveformGold = juce::Colour::fromString("0xffd4af37");
 static const juce::Colour waveformNeon = juce::Colour::fromString("0xff00ff88");
 
+/** Oscilloscope of one capture tap: min/max columns from a zero-crossing-triggered
+    window, auto-scaled to the signal. The grid and frame are drawn once per size into
+    a cached image, and the display only repaints when new audio has arrived. */
 class WaveformDisplay : public juce::Component,
                         public juce::Timer
 {
 public:
     WaveformDisplay() { startTimerHz(60); }
-    ~WaveformDisplay() override = default;
+
+    ~WaveformDisplay() override
+    {
+        setSource(nullptr);
+    }
+
+    /** The tap to show; capture runs only while a display is attached to it. */
+    void setSource(ScopeCapture* newSource)
+    {
+        if (source != nullptr)
+            source->setActive(false);
+
+        source = newSource;
+        window.fill({});
+
+        if (source != nullptr)
+            source->setActive(true);
+
+        repaint();
+    }
+
+    void setTraceColour(juce::Colour newColour)
+    {
+        traceColour = newColour;
+        repaint();
+    }
 
     void paint(juce::Graphics& g) override
     {
@@ -19,10 +48,75 @@ public:
         if (bounds.getWidth() <= 0 || bounds.getHeight() <= 0)
             return;
 
-        const double time = juce::Time::getMillisecondCounterHiRes() * 0.001;
-        const float pulse = 0.7f + 0.3f * std::sin(time * 2.5f);
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const auto pixelWidth = juce::roundToInt(bounds.getWidth() * scale);
+        const auto pixelHeight = juce::roundToInt(bounds.getHeight() * scale);
+
+        if (background.getWidth() != pixelWidth || background.getHeight() != pixelHeight)
+            background = renderBackground(pixelWidth, pixelHeight, scale);
+
+        g.drawImage(background, bounds);
+
+        // One min/max column per point across the width
+        const int columns = juce::jmax(1, getWidth() - 2);
+        const float amplitude = bounds.getHeight() * 0.42f / displayPeak;
+        const float centreY = bounds.getCentreY();
+        juce::RectangleList<float> trace;
+        trace.ensureStorageAllocated(columns);
+
+        for (int c = 0; c < columns; ++c)
+        {
+            const int first = c * windowPairs / columns;
+            const int last = juce::jmax(first + 1, (c + 1) * windowPairs / columns);
+            float low = window[(size_t) first].min, high = window[(size_t) first].max;
+
+            for (int i = first + 1; i < last; ++i)
+            {
+                low = juce::jmin(low, window[(size_t) i].min);
+                high = juce::jmax(high, window[(size_t) i].max);
+            }
+
+            const float top = centreY - high * amplitude;
+            const float height = juce::jmax(1.0f, (high - low) * amplitude);
+            trace.addWithoutMerging({ bounds.getX() + 1.0f + (float) c, top, 1.0f, height });
+        }
+
+        g.setColour(traceColour);
+        g.fillRectList(trace);
+    }
+
+    void timerCallback() override
+    {
+        if (source == nullptr || !source->update())
+            return;
+
+        source->getTriggeredWindow(window.data(), windowPairs);
+
+        float peak = 0.0f;
+        for (const auto& p : window)
+            peak = juce::jmax(peak, std::abs(p.min), std::abs(p.max));
 
-        // Professional dark background
+        // Rises at once, falls back slowly, and never magnifies near-silence
+        displayPeak = juce::jmax(peak, displayPeak * 0.97f, 0.05f);
+        repaint();
+    }
+
+private:
+    static constexpr int windowPairs = 512; // about 43 ms
+
+    ScopeCapture* source { nullptr };
+    std::array<ScopeCapture::Peak, windowPairs> window {};
+    float displayPeak { 1.0f };
+    juce::Colour traceColour { waveformAccent };
+    juce::Image background;
+
+    static juce::Image renderBackground(int pixelWidth, int pixelHeight, float scale)
+    {
+        juce::Image image(juce::Image::RGB, pixelWidth, pixelHeight, false);
+        juce::Graphics g(image);
+        g.addTransform(juce::AffineTransform::scale(scale));
+
+        const auto bounds = juce::Rectangle<float>(0.0f, 0.0f, (float) pixelWidth / scale, (float) pixelHeight / scale);
         g.fillAll(juce::Colour::fromRGB(12, 12, 15));
 
         // Grid lines for oscilloscope look
@@ -47,80 +141,6 @@ public:
         g.drawLine(bounds.getCentreX(), bounds.getY(), bounds.getCentreX(), bounds.getBottom(), 1.0f);
         g.drawLine(bounds.getX(), bounds.getCentreY(), bounds.getRight(), bounds.getCentreY(), 1.0f);
 
-        // Main waveform - clean and professional
-        juce::Path mainWave;
-        const int numPoints = 400;
-        const float amplitude = bounds.getHeight() * 0.35f;
-        const float centerY = bounds.getCentreY();
-
-        for (int i = 0; i <= numPoints; ++i)
-        {
-            const float x = bounds.getX() + (i / (float)numPoints) * bounds.getWidth();
-            const float t = (i / (float)numPoints) * juce::MathConstants<float>::twoPi * 2.0f + phaseOffset;
-            // Create a more complex waveform like Serum's LFO shapes
-            const float sine = std::sin(t);
-            const float triangle = std::asin(sine) * 2.0f / juce::MathConstants<float>::pi;
-            const float square = sine > 0 ? 1.0f : -1.0f;
-            const float saw = 2.0f * (t / juce::MathConstants<float>::twoPi - std::floor(t / juce::MathConstants<float>::twoPi + 0.5f));
-
-            // Blend between different shapes based on time
-            const float shapeBlend = (std::sin(time * 0.5f) + 1.0f) * 0.5f;
-            const float waveValue = sine * (1.0f - shapeBlend) + triangle * shapeBlend;
-
-            const float y = centerY + amplitude * waveValue * (0.8f + 0.2f * std::sin(t * 0.3f + time));
-
-            if (i == 0)
-                mainWave.startNewSubPath(x, y);
-            else
-                mainWave.lineTo(x, y);
-        }
-
-        // Professional glow effect
-        juce::ColourGradient waveGlow(waveformAccent.withAlpha(0.4f * pulse), bounds.getCentreX(), centerY - amplitude,
-                                      waveformAccent.withAlpha(0.0f), bounds.getCentreX(), centerY + amplitude, false);
-        g.setGradientFill(waveGlow);
-        g.strokePath(mainWave, juce::PathStrokeType(6.0f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
-
-        // Main waveform stroke
-        g.setColour(waveformAccent.withAlpha(0.9f));
-        g.strokePath(mainWave, juce::PathStrokeType(2.5f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
-
-        // Secondary waveform for depth
-        juce::Path secondaryWave;
-        for (int i = 0; i <= numPoints; ++i)
-        {
-            const float x = bounds.getX() + (i / (float)numPoints) * bounds.getWidth();
-            const float t = (i / (float)numPoints) * juce::MathConstants<float>::twoPi * 3.0f + phaseOffset * 1.3f;
-            const float y = centerY + amplitude * 0.6f * std::sin(t + time * 0.3f) * std::cos(t * 0.7f);
-
-            if (i == 0)
-                secondaryWave.startNewSubPath(x, y);
-            else
-                secondaryWave.lineTo(x, y);
-        }
-
-        g.setColour(waveformGold.withAlpha(0.6f * pulse));
-        g.strokePath(secondaryWave, juce::PathStrokeType(1.5f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
-
-        // Trigger indicator (like oscilloscope)
-        const float triggerX = bounds.getX() + bounds.getWidth() * 0.2f;
-        const float triggerY = centerY + amplitude * std::sin(phaseOffset * 2.0f);
-        g.setColour(waveformAccent);
-        g.fillEllipse(triggerX - 3, triggerY - 3, 6, 6);
-        g.setColour(juce::Colours::white);
-        g.drawEllipse(triggerX - 3, triggerY - 3, 6, 6, 1.0f);
-
-        // Measurement markers
-        g.setColour(waveformGold.withAlpha(0.7f));
-        // Peak markers
-        g.drawLine(bounds.getX() + 10, centerY - amplitude, bounds.getX() + 20, centerY - amplitude, 2.0f);
-        g.drawLine(bounds.getX() + 10, centerY + amplitude, bounds.getX() + 20, centerY + amplitude, 2.0f);
-
-        // Time markers
-        g.drawLine(bounds.getX() + bounds.getWidth() * 0.25f, bounds.getBottom() - 10, bounds.getX() + bounds.getWidth() * 0.25f, bounds.getBottom() - 20, 2.0f);
-        g.drawLine(bounds.getX() + bounds.getWidth() * 0.5f, bounds.getBottom() - 10, bounds.getX() + bounds.getWidth() * 0.5f, bounds.getBottom() - 20, 2.0f);
-        g.drawLine(bounds.getX() + bounds.getWidth() * 0.75f, bounds.getBottom() - 10, bounds.getX() + bounds.getWidth() * 0.75f, bounds.getBottom() - 20, 2.0f);
-
         // Border with professional styling
         g.setColour(juce::Colour::fromRGB(60, 60, 65));
         g.drawRect(bounds, 1.5f);
@@ -135,16 +155,7 @@ public:
         g.drawLine(bounds.getX(), bounds.getBottom(), bounds.getX(), bounds.getBottom() - 15, 2.0f);
         g.drawLine(bounds.getRight(), bounds.getBottom(), bounds.getRight() - 15, bounds.getBottom(), 2.0f);
         g.drawLine(bounds.getRight(), bounds.getBottom(), bounds.getRight(), bounds.getBottom() - 15, 2.0f);
-    }
 
-    void timerCallback() override
-    {
-        phaseOffset += 0.05f;
-        if (phaseOffset > juce::MathConstants<float>::twoPi)
-            phaseOffset -= juce::MathConstants<float>::twoPi;
-        repaint();
+        return image;
     }
-
-private:
-    float phaseOffset = 0.0f;
 };
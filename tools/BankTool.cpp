@@ -0,0 +1,80 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "../source/SampleBank.h"
+#include <iostream>
+
+/** Converts a per-key WAV stack folder into a packed .rvlbank file.
+
+    Usage: RavelandBankTool <stack-folder> [output.rvlbank]
+    Without an output path the bank is written next to the folder. */
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: RavelandBankTool <stack-folder> [output" << SampleBank::fileExtension << "]" << std::endl;
+        return 1;
+    }
+
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    const auto folder = cwd.getChildFile(juce::String::fromUTF8(argv[1]));
+    if (!folder.isDirectory())
+    {
+        std::cerr << "Not a folder: " << folder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const auto output = argc > 2 ? cwd.getChildFile(juce::String::fromUTF8(argv[2]))
+                                 : folder.getSiblingFile(folder.getFileName() + SampleBank::fileExtension);
+
+    juce::AudioFormatManager manager;
+    manager.registerBasicFormats();
+
+    const auto noteFiles = SampleBank::findNoteFiles(folder);
+    std::vector<SampleBank::Zone> zones;
+
+    for (int note = 0; note < 128; ++note)
+    {
+        const auto& file = noteFiles[(size_t) note];
+        if (file == juce::File())
+            continue;
+
+        std::unique_ptr<juce::AudioFormatReader> reader(manager.createReaderFor(file));
+        if (reader == nullptr)
+        {
+            std::cerr << "Skipping unreadable file: " << file.getFullPathName() << std::endl;
+            continue;
+        }
+
+        SampleBank::Zone zone;
+        zone.note = note;
+        zone.sampleRate = reader->sampleRate;
+        zone.sourceBitsPerSample = (int) reader->bitsPerSample;
+        zone.audio.setSize((int) reader->numChannels, (int) reader->lengthInSamples);
+        reader->read(zone.audio.getArrayOfWritePointers(), zone.audio.getNumChannels(), 0, zone.audio.getNumSamples());
+
+        // WAV smpl chunk loops are exposed by JUCE's reader as metadata
+        if (reader->metadataValues.getValue("NumSampleLoops", "0").getIntValue() > 0)
+        {
+            zone.loopStart = reader->metadataValues.getValue("Loop0Start", "-1").getLargeIntValue();
+            zone.loopEnd = reader->metadataValues.getValue("Loop0End", "-1").getLargeIntValue();
+        }
+
+        zones.push_back(std::move(zone));
+    }
+
+    if (zones.empty())
+    {
+        std::cerr << "No per-key WAV files found in " << folder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const auto numZones = zones.size();
+    if (!SampleBank::write(output, std::move(zones)))
+    {
+        std::cerr << "Failed to write " << output.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << numZones << " zones to " << output.getFullPathName()
+              << " (" << juce::File::descriptionOfSizeInBytes(output.getSize()) << ")" << std::endl;
+    return 0;
+}
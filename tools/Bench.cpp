@@ -0,0 +1,416 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../source/PluginProcessor.h"
+#include "../source/SynthVoice.h"
+#include <iostream>
+#include <limits>
+
+/** Microbenchmarks for the DSP kernels and the whole processBlock.
+
+    Usage: RavelandBench [--json results.json] [--label <text>] [--filter <group>] [--quick]
+
+    Every case reports nanoseconds per sample frame and its share of a real-time core
+    (the load at that rate). Per-voice cases also report how many voices one core could
+    run in real time at 64-sample blocks. --json writes the same results, plus the CPU,
+    the DSP kernel path and an optional label such as a commit hash, so runs can be compared. */
+namespace
+{
+    struct Result
+    {
+        juce::String group, name;
+        double sampleRate { 48000.0 };
+        int blockSize { 64 };
+        double nsPerSample { 0.0 };
+        double voicesPerCore { 0.0 }; // 0 for cases that aren't per voice
+
+        double getLoad() const { return nsPerSample * sampleRate * 1.0e-9; }
+    };
+
+    struct Bench
+    {
+        double minSeconds { 0.25 };
+        juce::String filter;
+        std::vector<Result> results;
+
+        bool wants(const juce::String& group) const { return filter.isEmpty() || group.containsIgnoreCase(filter); }
+
+        /** Best of five trials of repeated `run` calls, each of which processes `samplesPerCall` frames. */
+        template <typename Function>
+        double measure(Function&& run, int samplesPerCall) const
+        {
+            for (int i = 0; i < 16; ++i)
+                run();
+
+            double best = std::numeric_limits<double>::max();
+            for (int trial = 0; trial < 5; ++trial)
+            {
+                const auto start = juce::Time::getHighResolutionTicks();
+                juce::int64 calls = 0;
+                double elapsed = 0.0;
+
+                do
+                {
+                    run();
+                    ++calls;
+                    elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+                }
+                while (elapsed < minSeconds / 5.0);
+
+                best = juce::jmin(best, elapsed * 1.0e9 / ((double) calls * samplesPerCall));
+            }
+
+            return best;
+        }
+
+        void add(Result result, int voices = 0)
+        {
+            if (voices > 0)
+                result.voicesPerCore = (double) voices / result.getLoad();
+
+            std::cout << result.group.paddedRight(' ', 14) << result.name.paddedRight(' ', 22)
+                      << juce::String((int) result.sampleRate).paddedLeft(' ', 7) << " Hz"
+                      << juce::String(result.blockSize).paddedLeft(' ', 6)
+                      << juce::String(result.nsPerSample, 1).paddedLeft(' ', 11) << " ns/sample"
+                      << juce::String(result.getLoad() * 100.0, 2).paddedLeft(' ', 9) << " %";
+
+            if (result.voicesPerCore > 0.0)
+                std::cout << juce::String(result.voicesPerCore, 0).paddedLeft(' ', 9) << " voices/core";
+
+            std::cout << std::endl;
+            results.push_back(std::move(result));
+        }
+    };
+
+    constexpr double benchRate = 48000.0;
+    constexpr int benchBlock = 64;
+
+    void writeWav(const juce::File& file, const juce::AudioBuffer<float>& audio, double sampleRate, int bits)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(stream != nullptr
+            ? wav.createWriterFor(stream.get(), sampleRate, (unsigned int) audio.getNumChannels(), bits, {}, 0) : nullptr);
+
+        if (writer != nullptr)
+        {
+            stream.release();
+            writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+        }
+    }
+
+    /** Test material: a 12-harmonic saw per channel, slightly detuned, over a little noise. */
+    void fillTestSignal(juce::AudioBuffer<float>& buffer, double sampleRate, juce::int64 offset = 0)
+    {
+        juce::Random random(1);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const double t = (double) (offset + i) / sampleRate;
+                float s = 0.0f;
+                for (int h = 1; h <= 12; ++h)
+                    s += (float) std::sin(2.0 * juce::MathConstants<double>::pi * h * (220.0 + ch) * t) / (float) h;
+
+                data[i] = 0.3f * s + 0.05f * (random.nextFloat() * 2.0f - 1.0f);
+            }
+        }
+    }
+
+    void benchOscillator(Bench& bench)
+    {
+        for (int unison : { 1, 4, 8, 16, 32 })
+        {
+            SupersawOsc osc;
+            osc.prepare(benchRate);
+            osc.setFrequency(220.0f);
+            osc.setDetuneCents(50.0f);
+            osc.setNumVoices(unison);
+
+            std::array<float, benchBlock> out {};
+            const auto ns = bench.measure([&] { osc.renderBlock(out.data(), benchBlock); }, benchBlock);
+
+            bench.add({ "supersaw", "unison " + juce::String(unison), benchRate, benchBlock, ns }, 1);
+        }
+    }
+
+    void benchVoices(Bench& bench)
+    {
+        for (int polyphony : { 1, 4, 8, 16 })
+        {
+            std::vector<std::unique_ptr<RavelandVoice>> voices;
+            juce::dsp::ProcessSpec spec { benchRate, (juce::uint32) benchBlock, 2 };
+
+            for (int v = 0; v < polyphony; ++v)
+            {
+                auto voice = std::make_unique<RavelandVoice>();
+                voice->setCurrentPlaybackSampleRate(benchRate);
+                voice->prepare(spec);
+                voice->startNote(48 + v * 3, 0.8f, nullptr, 8192);
+                voices.push_back(std::move(voice));
+            }
+
+            juce::AudioBuffer<float> out(2, benchBlock);
+            const auto ns = bench.measure([&]
+            {
+                out.clear();
+                for (auto& voice : voices)
+                    voice->renderNextBlock(out, 0, benchBlock);
+            }, benchBlock);
+
+            bench.add({ "voice", "polyphony " + juce::String(polyphony), benchRate, benchBlock, ns }, polyphony);
+        }
+    }
+
+    void benchSampleLayer(Bench& bench, const juce::File& workDir)
+    {
+        // A small stack of 16-bit notes, read in each storage format
+        const auto stack = workDir.getChildFile("stack");
+        stack.createDirectory();
+
+        juce::AudioBuffer<float> audio(2, (int) (benchRate * 4));
+        fillTestSignal(audio, benchRate);
+        for (int note : { 48, 60, 72 })
+            writeWav(stack.getChildFile(juce::String(note).paddedLeft('0', 3) + ".wav"), audio, benchRate, 16);
+
+        const std::pair<SampleLayer::StorageFormat, const char*> formats[] = {
+            { SampleLayer::StorageFormat::automatic, "int16" },
+            { SampleLayer::StorageFormat::float32, "float32" },
+            { SampleLayer::StorageFormat::compressed, "compressed" }
+        };
+
+        for (const auto& [format, name] : formats)
+        {
+            SampleLayer layer;
+            layer.setStorageFormat(format);
+            if (!layer.loadFromFolder(stack, benchRate))
+                continue;
+
+            for (int note : { 60, 62 }) // on the zone root, and pitched up a whole tone
+            {
+                juce::AudioBuffer<float> out(2, benchBlock);
+                std::array<float, SampleLayer::renderScratchSize> scratch {};
+                double position = 0.0;
+
+                const auto ns = bench.measure([&]
+                {
+                    if (!layer.renderNote(note, position, benchRate, 0.8f, out, 0, benchBlock, scratch.data()))
+                        position = 0.0;
+                }, benchBlock);
+
+                bench.add({ "sampleLayer", juce::String(name) + (note == 60 ? " root" : " pitched"), benchRate, benchBlock, ns }, 1);
+            }
+        }
+    }
+
+    template <typename Stage>
+    void benchStage(Bench& bench, const juce::String& name, Stage& stage)
+    {
+        juce::AudioBuffer<float> input(2, benchBlock * 64), block(2, benchBlock);
+        fillTestSignal(input, benchRate);
+        int offset = 0;
+
+        const auto ns = bench.measure([&]
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                block.copyFrom(ch, 0, input, ch, offset, benchBlock);
+
+            stage(block);
+            offset = (offset + benchBlock) % input.getNumSamples();
+        }, benchBlock);
+
+        bench.add({ "fx", name, benchRate, benchBlock, ns });
+    }
+
+    void benchEffects(Bench& bench, const juce::File& workDir)
+    {
+        {
+            juce::dsp::Chorus<float> chorus;
+            chorus.prepare({ benchRate, (juce::uint32) benchBlock, 2 });
+            chorus.setMix(0.5f);
+            auto run = [&](juce::AudioBuffer<float>& b)
+            {
+                juce::dsp::AudioBlock<float> block(b);
+                chorus.process(juce::dsp::ProcessContextReplacing<float>(block));
+            };
+            benchStage(bench, "chorus classic", run);
+        }
+
+        for (int voices : { EnsembleChorus::minVoices, EnsembleChorus::maxVoices })
+        {
+            EnsembleChorus chorus;
+            chorus.prepare(benchRate, benchBlock);
+            chorus.setVoices(voices);
+            chorus.setParameters(1.5f, 0.5f, 0.5f);
+            auto run = [&](juce::AudioBuffer<float>& b) { chorus.process(b); };
+            benchStage(bench, "chorus ensemble " + juce::String(voices), run);
+        }
+
+        for (int index = 0; index < DistortionStage::getOversamplingNames().size(); ++index)
+        {
+            DistortionStage distortion;
+            distortion.prepare(benchRate, benchBlock, 2);
+            distortion.setOversamplingIndex(index);
+            distortion.setParameters(1.0f, 0.5f, 0.0f);
+            auto run = [&](juce::AudioBuffer<float>& b) { distortion.process(b); };
+            benchStage(bench, "distortion " + DistortionStage::getOversamplingNames()[index], run);
+        }
+
+        {
+            StereoDelay delay;
+            delay.prepare(benchRate, benchBlock, 2);
+            delay.setDelayTimeMs(250.0f);
+            delay.setFeedback(0.4f);
+            delay.setMix(0.3f);
+            auto run = [&](juce::AudioBuffer<float>& b) { delay.process(b, b.getNumSamples()); };
+            benchStage(bench, "delay", run);
+        }
+
+        {
+            FdnReverb reverb;
+            reverb.prepare(benchRate, benchBlock);
+            reverb.setParameters(0.5f, 0.35f, 0.3f);
+            auto run = [&](juce::AudioBuffer<float>& b) { reverb.process(b); };
+            benchStage(bench, "reverb fdn", run);
+        }
+
+        {
+            // A 3 s decaying noise IR; only the audio-thread head shows up here
+            juce::AudioBuffer<float> ir(2, (int) (benchRate * 3));
+            juce::Random random(2);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < ir.getNumSamples(); ++i)
+                    ir.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp(-3.0f * (float) i / ir.getNumSamples()));
+
+            const auto irFile = workDir.getChildFile("ir.wav");
+            writeWav(irFile, ir, benchRate, 24);
+
+            ConvolutionReverb reverb;
+            reverb.prepare(benchRate, benchBlock);
+            reverb.loadImpulseResponse(irFile);
+            reverb.setMix(0.3f);
+            for (int waited = 0; !reverb.isReady() && waited < 10000; waited += 10)
+                juce::Thread::sleep(10);
+
+            auto run = [&](juce::AudioBuffer<float>& b) { reverb.process(b); };
+            benchStage(bench, "reverb convolution", run);
+        }
+
+        {
+            TruePeakLimiter limiter;
+            limiter.prepare(benchRate, benchBlock, 2);
+            limiter.setCeilingDb(-1.0f);
+            auto run = [&](juce::AudioBuffer<float>& b) { b.applyGain(4.0f); limiter.process(b); };
+            benchStage(bench, "limiter (limiting)", run);
+        }
+    }
+
+    void benchProcessBlock(Bench& bench)
+    {
+        for (double sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+        {
+            for (int blockSize = 16; blockSize <= 2048; blockSize *= 2)
+            {
+                RavelandAudioProcessor processor;
+                processor.setCurrentProgram(1); // Rave: all FX on; each voice renders a single oscillator
+                processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor.prepareToPlay(sampleRate, blockSize);
+
+                // Hold an eight-note chord for the whole run
+                juce::AudioBuffer<float> buffer(2, blockSize);
+                juce::MidiBuffer midi;
+                for (int note : { 48, 55, 60, 64, 67, 71, 72, 76 })
+                    midi.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), 0);
+
+                processor.processBlock(buffer, midi);
+                midi.clear();
+
+                const auto ns = bench.measure([&] { processor.processBlock(buffer, midi); }, blockSize);
+                bench.add({ "processBlock", "rave 8 notes", sampleRate, blockSize, ns });
+
+                processor.releaseResources();
+            }
+        }
+    }
+
+    bool writeJson(const juce::File& file, const Bench& bench, const juce::String& label)
+    {
+        juce::Array<juce::var> results;
+        for (const auto& r : bench.results)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("group", r.group);
+            entry->setProperty("name", r.name);
+            entry->setProperty("sampleRate", r.sampleRate);
+            entry->setProperty("blockSize", r.blockSize);
+            entry->setProperty("nsPerSample", r.nsPerSample);
+            entry->setProperty("realtimeLoad", r.getLoad());
+            if (r.voicesPerCore > 0.0)
+                entry->setProperty("voicesPerCore", r.voicesPerCore);
+            results.add(juce::var(entry));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("label", label);
+        root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+        root->setProperty("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty("kernels", juce::String(DspKernels::get().name));
+        root->setProperty("cores", juce::SystemStats::getNumPhysicalCpus());
+        root->setProperty("results", results);
+
+        return file.replaceWithText(juce::JSON::toString(juce::var(root)));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Bench bench;
+    juce::File jsonFile;
+    juce::String label;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = juce::String::fromUTF8(argv[i]);
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--quick")
+            bench.minSeconds = 0.05;
+        else if (arg == "--json" && hasValue)
+            jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(juce::String::fromUTF8(argv[++i]));
+        else if (arg == "--label" && hasValue)
+            label = juce::String::fromUTF8(argv[++i]);
+        else if (arg == "--filter" && hasValue)
+            bench.filter = juce::String::fromUTF8(argv[++i]);
+        else
+        {
+            std::cerr << "Usage: RavelandBench [--json results.json] [--label <text>] [--filter <group>] [--quick]" << std::endl;
+            return 1;
+        }
+    }
+
+    // The parameter tree and sample pool expect a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ScopedNoDenormals noDenormals;
+
+    const auto workDir = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("RavelandBench");
+    workDir.createDirectory();
+
+    std::cout << "DSP kernels: " << DspKernels::get().name << " (set RAVELAND_ISA to compare)" << std::endl;
+
+    if (bench.wants("supersaw"))      benchOscillator(bench);
+    if (bench.wants("voice"))         benchVoices(bench);
+    if (bench.wants("sampleLayer"))   benchSampleLayer(bench, workDir);
+    if (bench.wants("fx"))            benchEffects(bench, workDir);
+    if (bench.wants("processBlock"))  benchProcessBlock(bench);
+
+    workDir.deleteRecursively();
+
+    if (jsonFile != juce::File() && !writeJson(jsonFile, bench, label))
+    {
+        std::cerr << "Can't write " << jsonFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,458 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../source/PluginProcessor.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+/** Golden-audio regression: renders fixed MIDI scenarios through every factory preset and
+    compares them with reference renders stored by an earlier, trusted build.
+
+    Usage: RavelandGolden record <reference-dir> [--filter <text>]
+           RavelandGolden verify <reference-dir> [--filter <text>] [--exact]
+
+    Each case belongs to a path (the dry synth, the dry synth plus a sample layer, or the
+    full preset with its FX) with its own tolerances for the peak and RMS sample error
+    and the mean log-spectral difference. --exact instead requires bit-identical output,
+    for changes that must not alter the sound at all; every path here is deterministic
+    on a given build and DSP kernel path (pin one with RAVELAND_ISA to compare exactly
+    across machines). References are 32-bit float WAVs, so recording loses nothing.
+    Verify exits with 2 if any case fails. */
+namespace
+{
+    constexpr double renderRate = 48000.0;
+    constexpr int renderBlock = 256;
+
+    struct Tolerance
+    {
+        float maxAbs;      // peak sample error
+        float rms;         // RMS sample error
+        float spectralDb;  // mean log-spectral difference over audible bins
+    };
+
+    enum class Path { synth, samples, fx };
+
+    const char* getPathName(Path path)
+    {
+        switch (path)
+        {
+            case Path::synth:   return "synth";
+            case Path::samples: return "samples";
+            case Path::fx:      return "fx";
+        }
+
+        return "";
+    }
+
+    /** The dry paths only allow rounding-level drift (about -80 dB); the FX
+        chain compounds error through feedback and nonlinearity, so it gets more room. */
+    Tolerance getTolerance(Path path)
+    {
+        switch (path)
+        {
+            case Path::synth:   return { 1.0e-4f, 1.0e-5f, 0.05f };
+            case Path::samples: return { 2.0e-4f, 2.0e-5f, 0.05f };
+            case Path::fx:      return { 1.0e-3f, 1.0e-4f, 0.25f };
+        }
+
+        return {};
+    }
+
+    struct Scenario
+    {
+        const char* name;
+        double seconds;
+        juce::MidiMessageSequence (*build)();
+    };
+
+    void addNote(juce::MidiMessageSequence& sequence, int note, double start, double length, float velocity)
+    {
+        sequence.addEvent(juce::MidiMessage::noteOn(1, note, velocity), start);
+        sequence.addEvent(juce::MidiMessage::noteOff(1, note), start + length);
+    }
+
+    /** A held minor chord, released into the FX tails. */
+    juce::MidiMessageSequence buildChord()
+    {
+        juce::MidiMessageSequence sequence;
+        for (int note : { 48, 60, 63, 67 })
+            addNote(sequence, note, 0.05, 1.5, 0.8f);
+        return sequence;
+    }
+
+    /** Sixteenths at 140 BPM over a held bass note, with varying velocity. */
+    juce::MidiMessageSequence buildArp()
+    {
+        static const int pattern[] = { 60, 63, 67, 72, 75, 72, 67, 63 };
+        const double step = 60.0 / 140.0 / 4.0;
+
+        juce::MidiMessageSequence sequence;
+        addNote(sequence, 36, 0.0, 2.5, 0.9f);
+        for (int i = 0; i < 32; ++i)
+            addNote(sequence, pattern[i % 8], i * step, step * 0.5, 0.5f + 0.05f * (float) (i % 8));
+        return sequence;
+    }
+
+    /** Four notes climbing to key 96, each starting before the last one is released. */
+    juce::MidiMessageSequence buildLegato()
+    {
+        juce::MidiMessageSequence sequence;
+        addNote(sequence, 60, 0.0, 0.6, 0.7f);
+        addNote(sequence, 67, 0.5, 0.6, 0.7f);
+        addNote(sequence, 72, 1.0, 0.6, 0.7f);
+        addNote(sequence, 96, 1.5, 0.4, 1.0f);
+        return sequence;
+    }
+
+    const Scenario scenarios[] = {
+        { "chord",  3.0, buildChord },
+        { "arp",    3.5, buildArp },
+        { "legato", 3.0, buildLegato },
+    };
+
+    struct Case
+    {
+        int preset;
+        const Scenario* scenario;
+        Path path;
+
+        juce::String getName() const
+        {
+            return "p" + juce::String(preset) + "-" + scenario->name + "-" + getPathName(path);
+        }
+    };
+
+    std::vector<Case> makeCases(int numPresets)
+    {
+        std::vector<Case> cases;
+        for (int preset = 0; preset < numPresets; ++preset)
+            for (const auto& scenario : scenarios)
+                cases.push_back({ preset, &scenario, Path::fx });
+
+        // Presets only differ past the voices, so the dry paths use the first one.
+        // Pitched reads between the stack's keys, and one at the top of the range.
+        cases.push_back({ 0, &scenarios[0], Path::synth });
+        cases.push_back({ 0, &scenarios[1], Path::synth });
+        cases.push_back({ 0, &scenarios[0], Path::samples });
+        cases.push_back({ 0, &scenarios[2], Path::samples });
+        return cases;
+    }
+
+    /** A per-key stack every sixth key, so most notes play pitched. Same content every run. */
+    juce::File writeStack(const juce::File& folder)
+    {
+        folder.createDirectory();
+        juce::AudioBuffer<float> audio(2, (int) renderRate);
+        juce::WavAudioFormat wav;
+
+        for (int note = 36; note <= 96; note += 6)
+        {
+            const double hz = juce::MidiMessage::getMidiNoteInHertz(note);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < audio.getNumSamples(); ++i)
+                {
+                    const double t = i / renderRate;
+                    const double s = std::sin(juce::MathConstants<double>::twoPi * hz * t)
+                                   + 0.3 * std::sin(juce::MathConstants<double>::twoPi * hz * (3.0 + 0.01 * ch) * t);
+                    audio.setSample(ch, i, (float) (0.5 * s * std::exp(-3.0 * t)));
+                }
+
+            const auto file = folder.getChildFile(juce::String(note).paddedLeft('0', 3) + ".wav");
+            file.deleteFile();
+            std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+            std::unique_ptr<juce::AudioFormatWriter> writer(stream != nullptr
+                ? wav.createWriterFor(stream.get(), renderRate, 2, 24, {}, 0) : nullptr);
+
+            if (writer != nullptr)
+            {
+                stream.release();
+                writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+            }
+        }
+
+        return folder;
+    }
+
+    /** A fresh processor per case, so no state leaks between them. */
+    juce::AudioBuffer<float> render(const Case& c, const juce::File& stack)
+    {
+        RavelandAudioProcessor processor;
+        processor.setNonRealtime(true);
+        processor.setCurrentProgram(c.preset);
+        processor.setRateAndBufferSizeDetails(renderRate, renderBlock);
+
+        auto& parameters = processor.getValueTreeState();
+        const auto set = [&parameters](const juce::String& id, float value) { *parameters.getRawParameterValue(id) = value; };
+
+        if (c.path != Path::fx)
+        {
+            FxChain chain;
+            chain.enabled.fill(false);
+            processor.setFxChain(chain);
+            set("limiterEnabled", 0.0f);
+        }
+
+        // The supersaw always sounds, so this path adds a sample layer on top of it.
+        // Random start points would make the render differ run to run.
+        if (c.path == Path::samples)
+        {
+            set("layer1Enabled", 1.0f);
+            set("layer1StartRand", 0.0f);
+            processor.loadSampleLayer(0, stack);
+        }
+
+        processor.prepareToPlay(renderRate, renderBlock);
+
+        const auto sequence = c.scenario->build();
+        const int totalSamples = (int) (c.scenario->seconds * renderRate);
+        juce::AudioBuffer<float> output(2, totalSamples);
+        juce::AudioBuffer<float> buffer(2, renderBlock);
+        juce::MidiBuffer midi;
+        int nextEvent = 0;
+
+        for (int position = 0; position < totalSamples; position += renderBlock)
+        {
+            const int numSamples = juce::jmin(renderBlock, totalSamples - position);
+
+            midi.clear();
+            for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+            {
+                const auto& message = sequence.getEventPointer(nextEvent)->message;
+                const int samplePosition = (int) (message.getTimeStamp() * renderRate);
+                if (samplePosition >= position + numSamples)
+                    break;
+
+                midi.addEvent(message, juce::jmax(0, samplePosition - position));
+            }
+
+            buffer.setSize(2, numSamples, false, false, true);
+            processor.processBlock(buffer, midi);
+
+            for (int ch = 0; ch < 2; ++ch)
+                output.copyFrom(ch, position, buffer, ch, 0, numSamples);
+        }
+
+        processor.releaseResources();
+        return output;
+    }
+
+    bool writeReference(const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(stream != nullptr
+            ? wav.createWriterFor(stream.get(), renderRate, 2, 32, {}, 0) : nullptr);
+
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+        return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+    }
+
+    bool readReference(const juce::File& file, juce::AudioBuffer<float>& audio)
+    {
+        auto stream = file.createInputStream();
+        if (stream == nullptr)
+            return false;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader(wav.createReaderFor(stream.release(), true));
+        if (reader == nullptr || reader->numChannels != 2)
+            return false;
+
+        audio.setSize(2, (int) reader->lengthInSamples);
+        return reader->read(&audio, 0, audio.getNumSamples(), 0, true, true);
+    }
+
+    struct Difference
+    {
+        float maxAbs { 0.0f };
+        float rms { 0.0f };
+        float spectralDb { 0.0f };
+        bool identical { true };
+    };
+
+    /** Mean absolute difference in dB between Hann-windowed magnitude spectra, over bins
+        within 90 dB of the loudest bin in the reference. */
+    float spectralDifference(const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& actual)
+    {
+        constexpr int order = 12;
+        constexpr int size = 1 << order;
+        juce::dsp::FFT fft(order);
+        juce::dsp::WindowingFunction<float> window((size_t) size, juce::dsp::WindowingFunction<float>::hann, false);
+
+        std::vector<float> ref((size_t) size * 2), act((size_t) size * 2);
+        std::vector<float> refFrames, actFrames;
+        float loudest = 0.0f;
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int start = 0; start + size <= reference.getNumSamples(); start += size / 2)
+            {
+                std::fill(ref.begin(), ref.end(), 0.0f);
+                std::fill(act.begin(), act.end(), 0.0f);
+                std::copy_n(reference.getReadPointer(ch, start), size, ref.begin());
+                std::copy_n(actual.getReadPointer(ch, start), size, act.begin());
+
+                window.multiplyWithWindowingTable(ref.data(), (size_t) size);
+                window.multiplyWithWindowingTable(act.data(), (size_t) size);
+                fft.performFrequencyOnlyForwardTransform(ref.data());
+                fft.performFrequencyOnlyForwardTransform(act.data());
+
+                for (int bin = 1; bin < size / 2; ++bin)
+                {
+                    refFrames.push_back(ref[(size_t) bin]);
+                    actFrames.push_back(act[(size_t) bin]);
+                    loudest = juce::jmax(loudest, ref[(size_t) bin]);
+                }
+            }
+        }
+
+        const float floor = loudest * juce::Decibels::decibelsToGain(-90.0f);
+        double sum = 0.0;
+        int count = 0;
+
+        for (size_t i = 0; i < refFrames.size(); ++i)
+        {
+            if (refFrames[i] < floor && actFrames[i] < floor)
+                continue;
+
+            sum += std::abs(juce::Decibels::gainToDecibels(actFrames[i] + floor, -200.0f)
+                            - juce::Decibels::gainToDecibels(refFrames[i] + floor, -200.0f));
+            ++count;
+        }
+
+        return count > 0 ? (float) (sum / count) : 0.0f;
+    }
+
+    Difference compare(const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& actual)
+    {
+        Difference d;
+        double sumSquares = 0.0;
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            const auto* r = reference.getReadPointer(ch);
+            const auto* a = actual.getReadPointer(ch);
+
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+            {
+                const float e = a[i] - r[i];
+                d.identical = d.identical && std::memcmp(&a[i], &r[i], sizeof(float)) == 0;
+                d.maxAbs = juce::jmax(d.maxAbs, std::abs(e));
+                sumSquares += (double) e * e;
+            }
+        }
+
+        d.rms = (float) std::sqrt(sumSquares / (2.0 * juce::jmax(1, reference.getNumSamples())));
+        d.spectralDb = spectralDifference(reference, actual);
+        return d;
+    }
+
+    juce::String formatError(float value)
+    {
+        return (value > 0.0f ? juce::String(juce::Decibels::gainToDecibels(value), 1) + " dB" : juce::String("-inf dB")).paddedLeft(' ', 10);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const auto mode = juce::String::fromUTF8(argc > 1 ? argv[1] : "");
+    juce::File referenceDir;
+    juce::String filter;
+    bool exact = false;
+    bool ok = (mode == "record" || mode == "verify") && argc > 2;
+
+    for (int i = 2; ok && i < argc; ++i)
+    {
+        const auto arg = juce::String::fromUTF8(argv[i]);
+
+        if (arg == "--exact")                       exact = true;
+        else if (arg == "--filter" && i + 1 < argc) filter = juce::String::fromUTF8(argv[++i]);
+        else if (!arg.startsWith("--") && referenceDir == juce::File())
+            referenceDir = juce::File::getCurrentWorkingDirectory().getChildFile(arg);
+        else                                        ok = false;
+    }
+
+    if (!ok || referenceDir == juce::File())
+    {
+        std::cerr << "Usage: RavelandGolden record <reference-dir> [--filter <text>]" << std::endl
+                  << "       RavelandGolden verify <reference-dir> [--filter <text>] [--exact]" << std::endl;
+        return 1;
+    }
+
+    // The parameter tree and sample pool expect a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto workDir = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("RavelandGolden");
+    const auto stack = writeStack(workDir.getChildFile("stack"));
+    const bool recording = mode == "record";
+
+    if (recording && !referenceDir.createDirectory())
+    {
+        std::cerr << "Can't create " << referenceDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::cout << "DSP kernels: " << DspKernels::get().name << std::endl;
+
+    const int numPresets = RavelandAudioProcessor().getNumPrograms();
+    int failures = 0, checked = 0;
+
+    for (const auto& c : makeCases(numPresets))
+    {
+        const auto name = c.getName();
+        if (filter.isNotEmpty() && !name.containsIgnoreCase(filter))
+            continue;
+
+        const auto file = referenceDir.getChildFile(name + ".wav");
+        const auto actual = render(c, stack);
+        ++checked;
+
+        if (recording)
+        {
+            if (!writeReference(file, actual))
+            {
+                std::cerr << "Can't write " << file.getFullPathName() << std::endl;
+                return 1;
+            }
+
+            std::cout << "recorded  " << name << std::endl;
+            continue;
+        }
+
+        juce::AudioBuffer<float> reference;
+        if (!readReference(file, reference) || reference.getNumSamples() != actual.getNumSamples())
+        {
+            std::cout << "MISSING   " << name << " (no matching reference; record one first)" << std::endl;
+            ++failures;
+            continue;
+        }
+
+        const auto d = compare(reference, actual);
+        const auto tolerance = getTolerance(c.path);
+        const bool pass = exact ? d.identical
+                                : d.maxAbs <= tolerance.maxAbs && d.rms <= tolerance.rms && d.spectralDb <= tolerance.spectralDb;
+
+        std::cout << (pass ? "ok        " : "FAIL      ") << name.paddedRight(' ', 22)
+                  << " max" << formatError(d.maxAbs) << "   rms" << formatError(d.rms)
+                  << "   spectral " << juce::String(d.spectralDb, 3).paddedLeft(' ', 7) << " dB"
+                  << (d.identical ? "   bit-exact" : "") << std::endl;
+
+        failures += pass ? 0 : 1;
+    }
+
+    workDir.deleteRecursively();
+
+    if (recording)
+    {
+        std::cout << checked << " references written to " << referenceDir.getFullPathName() << std::endl;
+        return 0;
+    }
+
+    std::cout << checked - failures << " of " << checked << " cases match"
+              << (exact ? " bit-exactly" : " within tolerance") << std::endl;
+    return failures > 0 ? 2 : 0;
+}
@@ -0,0 +1,358 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "../source/SampleLayer.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#if JUCE_LINUX
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <fstream>
+ #include <sstream>
+#endif
+
+/** Sample-stack load time and memory.
+
+    Usage: RavelandLoadBench [--notes 128] [--seconds 2] [--channels 1,2] [--bits 16,24,32]
+                             [--rates 44100,48000,96000] [--runs 3] [--format auto|float|compressed]
+                             [--dir path] [--csv results.csv]
+
+    Writes a synthetic per-key WAV stack for every combination of channel count, bit
+    depth (32 = float) and sample rate, then times SampleLayer::loadFromFolder on it,
+    each with a fresh SamplePool as a newly opened plugin would have. Each run
+    measures a cold load, with the stack's files dropped from the page cache first,
+    then a warm one. It reports median wall time, time until the first note renders,
+    peak RSS growth, resident sample memory, read syscalls and bytes read, both in
+    total and from storage.
+
+    Page-cache control, peak RSS and I/O counters come from Linux (posix_fadvise,
+    /proc/self). Elsewhere only warm loads run and those columns show -1. Use --dir
+    to put the stacks on the drive you care about; the temp directory may be a RAM disk. */
+namespace
+{
+    struct Config
+    {
+        int channels;
+        int bits;
+        double rate;
+
+        juce::String describe() const
+        {
+            return juce::String(channels == 1 ? "mono" : "stereo") + " "
+                 + (bits == 32 ? juce::String("float") : juce::String(bits) + "-bit") + " "
+                 + juce::String(rate / 1000.0, 1) + " kHz";
+        }
+    };
+
+    /** I/O and memory counters for this process; -1 where the platform has none. */
+    struct Counters
+    {
+        juce::int64 readCalls { -1 };
+        juce::int64 bytesRead { -1 };
+        juce::int64 storageBytesRead { -1 };
+        juce::int64 residentBytes { -1 };
+        juce::int64 peakResidentBytes { -1 };
+    };
+
+    struct Result
+    {
+        double loadMs { 0.0 };
+        double firstNoteMs { 0.0 };
+        double peakGrowthMB { -1.0 };
+        double sampleMemoryMB { 0.0 };
+        juce::int64 readCalls { -1 };
+        double readMB { -1.0 };
+        double storageMB { -1.0 };
+    };
+
+   #if JUCE_LINUX
+    /** /proc files report a size of 0, so read them to the end rather than by size. */
+    juce::String readProcFile(const char* path)
+    {
+        std::ifstream in(path);
+        std::stringstream text;
+        text << in.rdbuf();
+        return juce::String(text.str());
+    }
+
+    juce::int64 readProcValue(const juce::String& text, const juce::String& key)
+    {
+        for (const auto& line : juce::StringArray::fromLines(text))
+            if (line.startsWith(key))
+                return line.fromFirstOccurrenceOf(key, false, false).trim().getLargeIntValue();
+
+        return -1;
+    }
+   #endif
+
+    Counters readCounters()
+    {
+        Counters c;
+       #if JUCE_LINUX
+        const auto io = readProcFile("/proc/self/io");
+        c.readCalls = readProcValue(io, "syscr:");
+        c.bytesRead = readProcValue(io, "rchar:");
+        c.storageBytesRead = readProcValue(io, "read_bytes:");
+
+        const auto status = readProcFile("/proc/self/status");
+        c.residentBytes = readProcValue(status, "VmRSS:") * 1024;      // reported in kB
+        c.peakResidentBytes = readProcValue(status, "VmHWM:") * 1024;
+       #endif
+        return c;
+    }
+
+    /** Restarts the peak RSS count from the current RSS. */
+    void resetPeakResident()
+    {
+       #if JUCE_LINUX
+        const int fd = ::open("/proc/self/clear_refs", O_WRONLY);
+        if (fd >= 0)
+        {
+            juce::ignoreUnused(::write(fd, "5", 1));
+            ::close(fd);
+        }
+       #endif
+    }
+
+    /** Flushes and evicts the stack's files from the page cache, so the next load reads
+        storage. Needs no privileges, unlike dropping the whole cache. */
+    bool dropFromPageCache(const juce::File& folder)
+    {
+       #if JUCE_LINUX
+        for (const auto& entry : juce::RangedDirectoryIterator(folder, false, "*.wav", juce::File::findFiles))
+        {
+            const int fd = ::open(entry.getFile().getFullPathName().toRawUTF8(), O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            ::fdatasync(fd);
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+
+        return true;
+       #else
+        juce::ignoreUnused(folder);
+        return false;
+       #endif
+    }
+
+    /** A decaying two-partial tone; every note gets the same audio, under its own file name. */
+    juce::int64 writeStack(const juce::File& folder, const Config& config, int numNotes, double seconds)
+    {
+        folder.deleteRecursively();
+        folder.createDirectory();
+
+        juce::AudioBuffer<float> audio(config.channels, juce::jmax(1, (int) (seconds * config.rate)));
+        for (int ch = 0; ch < config.channels; ++ch)
+            for (int i = 0; i < audio.getNumSamples(); ++i)
+            {
+                const double t = i / config.rate;
+                const double s = std::sin(juce::MathConstants<double>::twoPi * 220.0 * t)
+                               + 0.3 * std::sin(juce::MathConstants<double>::twoPi * (661.0 + ch) * t);
+                audio.setSample(ch, i, (float) (0.5 * s * std::exp(-t)));
+            }
+
+        juce::WavAudioFormat wav;
+        juce::int64 totalBytes = 0;
+
+        for (int n = 0; n < numNotes; ++n)
+        {
+            // Spread over the keyboard when the stack is sparse
+            const int note = numNotes >= 128 ? n : n * 128 / numNotes;
+            const auto file = folder.getChildFile(juce::String(note).paddedLeft('0', 3) + ".wav");
+
+            std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+            std::unique_ptr<juce::AudioFormatWriter> writer(stream != nullptr
+                ? wav.createWriterFor(stream.get(), config.rate, (unsigned int) config.channels, config.bits, {}, 0) : nullptr);
+
+            if (writer == nullptr)
+                return -1;
+
+            stream.release();
+            writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+            writer.reset();
+            totalBytes += file.getSize();
+        }
+
+        return totalBytes;
+    }
+
+    /** One load as a newly opened plugin does it: its own pool, so nothing is shared or
+        memoised from an earlier run. The first note is ready once it renders a block. */
+    Result measureLoad(const juce::File& folder, SampleLayer::StorageFormat format, int firstNote)
+    {
+        Result result;
+        juce::SharedResourcePointer<SamplePool> pool;
+
+        resetPeakResident();
+        const auto before = readCounters();
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        SampleLayer layer;
+        layer.setStorageFormat(format);
+        layer.loadFromFolder(folder, 0.0);
+        const auto loaded = juce::Time::getHighResolutionTicks();
+
+        juce::AudioBuffer<float> block(2, 256);
+        float scratch[SampleLayer::renderScratchSize];
+        double position = 0.0;
+        block.clear();
+        layer.renderNote(firstNote, position, 48000.0, 1.0f, block, 0, block.getNumSamples(), scratch);
+        const auto ready = juce::Time::getHighResolutionTicks();
+
+        const auto after = readCounters();
+
+        result.loadMs = juce::Time::highResolutionTicksToSeconds(loaded - start) * 1000.0;
+        result.firstNoteMs = juce::Time::highResolutionTicksToSeconds(ready - start) * 1000.0;
+        result.sampleMemoryMB = (double) layer.getMemoryUsage() / (1024.0 * 1024.0);
+
+        if (after.peakResidentBytes >= 0)
+        {
+            result.peakGrowthMB = (double) (after.peakResidentBytes - before.residentBytes) / (1024.0 * 1024.0);
+            result.readCalls = after.readCalls - before.readCalls;
+            result.readMB = (double) (after.bytesRead - before.bytesRead) / (1024.0 * 1024.0);
+            result.storageMB = (double) (after.storageBytesRead - before.storageBytesRead) / (1024.0 * 1024.0);
+        }
+
+        return result;
+    }
+
+    /** Median of each column across runs. */
+    Result median(std::vector<Result> runs)
+    {
+        const auto mid = runs.size() / 2;
+        auto pick = [&](auto member)
+        {
+            std::sort(runs.begin(), runs.end(), [member](const Result& a, const Result& b) { return a.*member < b.*member; });
+            return runs[mid].*member;
+        };
+
+        Result r;
+        r.loadMs = pick(&Result::loadMs);
+        r.firstNoteMs = pick(&Result::firstNoteMs);
+        r.peakGrowthMB = pick(&Result::peakGrowthMB);
+        r.sampleMemoryMB = pick(&Result::sampleMemoryMB);
+        r.readCalls = pick(&Result::readCalls);
+        r.readMB = pick(&Result::readMB);
+        r.storageMB = pick(&Result::storageMB);
+        return r;
+    }
+
+    juce::Array<int> parseList(const juce::String& text)
+    {
+        juce::Array<int> values;
+        for (const auto& item : juce::StringArray::fromTokens(text, ",", {}))
+            if (item.getIntValue() > 0)
+                values.add(item.getIntValue());
+
+        return values;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int numNotes = 128, runs = 3;
+    double seconds = 2.0;
+    juce::Array<int> channelCounts { 1, 2 }, bitDepths { 16, 24, 32 }, rates { 44100, 48000, 96000 };
+    auto format = SampleLayer::StorageFormat::automatic;
+    auto baseDir = juce::File::getSpecialLocation(juce::File::tempDirectory);
+    juce::File csvFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = juce::String::fromUTF8(argv[i]);
+        const auto value = i + 1 < argc ? juce::String::fromUTF8(argv[i + 1]) : juce::String();
+
+        if (arg == "--notes" && value.isNotEmpty())          numNotes = juce::jlimit(1, 128, value.getIntValue());
+        else if (arg == "--seconds" && value.isNotEmpty())   seconds = value.getDoubleValue();
+        else if (arg == "--channels" && value.isNotEmpty())  channelCounts = parseList(value);
+        else if (arg == "--bits" && value.isNotEmpty())      bitDepths = parseList(value);
+        else if (arg == "--rates" && value.isNotEmpty())     rates = parseList(value);
+        else if (arg == "--runs" && value.isNotEmpty())      runs = juce::jmax(1, value.getIntValue());
+        else if (arg == "--dir" && value.isNotEmpty())       baseDir = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (arg == "--csv" && value.isNotEmpty())       csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (arg == "--format" && value == "auto")       format = SampleLayer::StorageFormat::automatic;
+        else if (arg == "--format" && value == "float")      format = SampleLayer::StorageFormat::float32;
+        else if (arg == "--format" && value == "compressed") format = SampleLayer::StorageFormat::compressed;
+        else
+        {
+            std::cerr << "Usage: RavelandLoadBench [--notes 128] [--seconds 2] [--channels 1,2] [--bits 16,24,32]" << std::endl
+                      << "                         [--rates 44100,48000,96000] [--runs 3] [--format auto|float|compressed]" << std::endl
+                      << "                         [--dir path] [--csv results.csv]" << std::endl;
+            return 1;
+        }
+
+        ++i;
+    }
+
+    if (seconds <= 0.0 || channelCounts.isEmpty() || bitDepths.isEmpty() || rates.isEmpty())
+    {
+        std::cerr << "Nothing to run" << std::endl;
+        return 1;
+    }
+
+    const auto stack = baseDir.getChildFile("RavelandLoadBench");
+    const int firstNote = numNotes >= 128 ? 60 : 0;
+    juce::String csv = "config,notes,seconds,disk_mb,cache,load_ms,first_note_ms,peak_rss_growth_mb,sample_memory_mb,read_calls,read_mb,storage_read_mb\n";
+
+    std::cout << numNotes << " notes x " << seconds << " s, median of " << runs << " run(s), stacks in "
+              << stack.getFullPathName() << std::endl << std::endl
+              << juce::String("stack").paddedRight(' ', 24) << juce::String("disk MB").paddedLeft(' ', 9) << "  cache"
+              << juce::String("load ms").paddedLeft(' ', 10) << juce::String("1st note").paddedLeft(' ', 10)
+              << juce::String("peak +MB").paddedLeft(' ', 10) << juce::String("held MB").paddedLeft(' ', 9)
+              << juce::String("reads").paddedLeft(' ', 8) << juce::String("read MB").paddedLeft(' ', 9)
+              << juce::String("disk rd MB").paddedLeft(' ', 11) << std::endl;
+
+    for (int channels : channelCounts)
+        for (int bits : bitDepths)
+            for (int rate : rates)
+            {
+                const Config config { juce::jlimit(1, 2, channels), bits, (double) rate };
+                const auto diskBytes = writeStack(stack, config, numNotes, seconds);
+                if (diskBytes < 0)
+                {
+                    std::cerr << "Can't write " << config.describe() << " stack to " << stack.getFullPathName() << std::endl;
+                    continue;
+                }
+
+                std::vector<Result> cold, warm;
+                for (int run = 0; run < runs; ++run)
+                {
+                    if (dropFromPageCache(stack))
+                        cold.push_back(measureLoad(stack, format, firstNote));
+
+                    warm.push_back(measureLoad(stack, format, firstNote));
+                }
+
+                const double diskMB = (double) diskBytes / (1024.0 * 1024.0);
+
+                for (const auto& [cache, results] : { std::make_pair("cold", &cold), std::make_pair("warm", &warm) })
+                {
+                    if (results->empty())
+                        continue;
+
+                    const auto r = median(*results);
+                    std::cout << config.describe().paddedRight(' ', 24) << juce::String(diskMB, 1).paddedLeft(' ', 9)
+                              << "  " << cache << juce::String(r.loadMs, 1).paddedLeft(' ', 10)
+                              << juce::String(r.firstNoteMs, 1).paddedLeft(' ', 10)
+                              << juce::String(r.peakGrowthMB, 1).paddedLeft(' ', 10)
+                              << juce::String(r.sampleMemoryMB, 1).paddedLeft(' ', 9)
+                              << juce::String(r.readCalls).paddedLeft(' ', 8)
+                              << juce::String(r.readMB, 1).paddedLeft(' ', 9)
+                              << juce::String(r.storageMB, 1).paddedLeft(' ', 11) << std::endl;
+
+                    csv << config.describe() << "," << numNotes << "," << seconds << "," << juce::String(diskMB, 2) << ","
+                        << cache << "," << juce::String(r.loadMs, 3) << "," << juce::String(r.firstNoteMs, 3) << ","
+                        << juce::String(r.peakGrowthMB, 2) << "," << juce::String(r.sampleMemoryMB, 2) << ","
+                        << r.readCalls << "," << juce::String(r.readMB, 2) << "," << juce::String(r.storageMB, 2) << "\n";
+                }
+            }
+
+    stack.deleteRecursively();
+
+    if (csvFile != juce::File() && !csvFile.replaceWithText(csv))
+        std::cerr << "Can't write " << csvFile.getFullPathName() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../source/PluginProcessor.h"
+#include "../source/PluginEditor.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+/** Times editor frames, drawn offscreen with the software renderer.
+
+    Usage: RavelandPaintBench [--frames 120]
+
+    The editor is never put on the desktop, so this runs on a machine with no display
+    or GPU. Each frame is drawn into a juce::Image the way a repaint of the whole window
+    would be. The editor is drawn at its minimum, default and maximum sizes, each at
+    1x, 1.5x and 2x scale. Alongside the full frame it times each component's own paint()
+    on its own, without children, grouped by type, to show where a frame goes. */
+namespace
+{
+    struct Group
+    {
+        int count { 0 };
+        juce::int64 ticks { 0 };
+    };
+
+    juce::String getGroupName(juce::Component& component, juce::Component& editor)
+    {
+        if (&component == &editor)                                  return "editor";
+        if (dynamic_cast<WaveformDisplay*>(&component) != nullptr)  return "WaveformDisplay";
+        if (dynamic_cast<FancyKnob*>(&component) != nullptr)        return "FancyKnob";
+        if (dynamic_cast<LoadMeterDisplay*>(&component) != nullptr) return "LoadMeterDisplay";
+        if (dynamic_cast<juce::Label*>(&component) != nullptr)      return "Label";
+        if (dynamic_cast<juce::Button*>(&component) != nullptr)     return "Button";
+        if (dynamic_cast<juce::ComboBox*>(&component) != nullptr)   return "ComboBox";
+        return "other";
+    }
+
+    /** The editor and every visible component under it. */
+    void collect(juce::Component& component, juce::Array<juce::Component*>& components)
+    {
+        if (!component.isVisible() || component.getWidth() <= 0 || component.getHeight() <= 0)
+            return;
+
+        components.add(&component);
+        for (auto* child : component.getChildren())
+            collect(*child, components);
+    }
+
+    double toMs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+
+    void run(juce::Component& editor, int width, int height, float scale, int frames)
+    {
+        editor.setSize(width, height);
+
+        juce::Image frame(juce::Image::ARGB, juce::roundToInt((float) width * scale), juce::roundToInt((float) height * scale),
+                          true, juce::SoftwareImageType());
+
+        // Whole frames, as a repaint of the full window draws them
+        std::vector<juce::int64> frameTicks;
+        for (int i = -5; i < frames; ++i)
+        {
+            frame.clear(frame.getBounds());
+            juce::Graphics g(frame);
+            g.addTransform(juce::AffineTransform::scale(scale));
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            editor.paintEntireComponent(g, false);
+            if (i >= 0)
+                frameTicks.push_back(juce::Time::getHighResolutionTicks() - start);
+        }
+
+        std::sort(frameTicks.begin(), frameTicks.end());
+        juce::int64 total = 0;
+        for (auto t : frameTicks)
+            total += t;
+
+        // Each component's own paint(), children excluded, into an image of its size
+        juce::Array<juce::Component*> components;
+        collect(editor, components);
+
+        std::map<juce::String, Group> groups;
+        for (auto* component : components)
+        {
+            juce::Image image(juce::Image::ARGB, juce::roundToInt((float) component->getWidth() * scale),
+                              juce::roundToInt((float) component->getHeight() * scale), true, juce::SoftwareImageType());
+            auto& group = groups[getGroupName(*component, editor)];
+            ++group.count;
+
+            for (int i = -2; i < frames; ++i)
+            {
+                image.clear(image.getBounds());
+                juce::Graphics g(image);
+                g.addTransform(juce::AffineTransform::scale(scale));
+
+                const auto start = juce::Time::getHighResolutionTicks();
+                component->paint(g);
+                if (i >= 0)
+                    group.ticks += juce::Time::getHighResolutionTicks() - start;
+            }
+        }
+
+        std::cout << width << "x" << height << " @ " << juce::String(scale, 1) << "x (" << frame.getWidth() << "x"
+                  << frame.getHeight() << " px)" << std::endl
+                  << "  " << juce::String("full frame").paddedRight(' ', 20)
+                  << juce::String(toMs(total) / (double) frames, 2).paddedLeft(' ', 8) << " ms   p95 "
+                  << juce::String(toMs(frameTicks[(size_t) (frameTicks.size() * 95 / 100)]), 2) << " ms, "
+                  << juce::String(100.0 * toMs(total) / (double) frames * 60.0 / 1000.0, 0) << "% of a core at 60 fps" << std::endl;
+
+        std::vector<std::pair<juce::String, Group>> sorted(groups.begin(), groups.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second.ticks > b.second.ticks; });
+
+        for (const auto& [name, group] : sorted)
+            std::cout << "    " << name.paddedRight(' ', 18)
+                      << juce::String(toMs(group.ticks) / (double) frames, 3).paddedLeft(' ', 8) << " ms"
+                      << juce::String(group.count).paddedLeft(' ', 6) << " x" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = 120;
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = juce::String::fromUTF8(argv[i]);
+        if (arg == "--frames" && i + 1 < argc)
+        {
+            frames = juce::jmax(1, juce::String::fromUTF8(argv[++i]).getIntValue());
+        }
+        else
+        {
+            std::cerr << "Usage: RavelandPaintBench [--frames 120]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Components need the message manager, but nothing here opens a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RavelandAudioProcessor processor;
+    std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditorIfNeeded());
+
+    const int defaultWidth = editor->getWidth();
+    const int defaultHeight = editor->getHeight();
+    auto* constrainer = editor->getConstrainer();
+
+    const std::pair<int, int> sizes[] = {
+        { constrainer->getMinimumWidth(), constrainer->getMinimumHeight() },
+        { defaultWidth, defaultHeight },
+        { constrainer->getMaximumWidth(), constrainer->getMaximumHeight() },
+    };
+
+    for (const auto& [width, height] : sizes)
+        for (float scale : { 1.0f, 1.5f, 2.0f })
+            run(*editor, width, height, scale, frames);
+
+    return 0;
+}
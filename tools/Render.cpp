@@ -0,0 +1,236 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../source/PluginProcessor.h"
+#include <iostream>
+
+/** Renders a Standard MIDI File through RavelandAudioProcessor to a WAV file, offline.
+
+    Usage: RavelandRender <input.mid> <output.wav> [--rate 48000] [--block 512]
+                          [--preset <index> | --state <file>] [--bits 24] [--tail <seconds>]
+                          [--trace <file.json>]
+
+    --state takes a saved plugin state, either the binary blob a host stores or its XML.
+    The output is latency-compensated, so notes land where the MIDI file puts them. When
+    it finishes the tool prints the real-time factor and the time spent in each section
+    of processBlock. --trace also writes a Chrome trace-event timeline of the render,
+    for chrome://tracing or Perfetto. */
+namespace
+{
+    struct Options
+    {
+        juce::File midiFile, outputFile, stateFile, traceFile;
+        double sampleRate { 48000.0 };
+        int blockSize { 512 };
+        int preset { -1 };
+        int bitsPerSample { 24 };
+        double tailSeconds { -1.0 }; // -1: the processor's own tail length, capped
+    };
+
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+        juce::StringArray positional;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const auto arg = juce::String::fromUTF8(argv[i]);
+
+            if (arg.startsWith("--"))
+            {
+                if (i + 1 >= argc)
+                    return false;
+
+                const auto value = juce::String::fromUTF8(argv[++i]);
+
+                if (arg == "--rate")         options.sampleRate = value.getDoubleValue();
+                else if (arg == "--block")   options.blockSize = value.getIntValue();
+                else if (arg == "--preset")  options.preset = value.getIntValue();
+                else if (arg == "--state")   options.stateFile = cwd.getChildFile(value);
+                else if (arg == "--bits")    options.bitsPerSample = value.getIntValue();
+                else if (arg == "--tail")    options.tailSeconds = value.getDoubleValue();
+                else if (arg == "--trace")   options.traceFile = cwd.getChildFile(value);
+                else                         return false;
+            }
+            else
+            {
+                positional.add(arg);
+            }
+        }
+
+        if (positional.size() != 2 || options.sampleRate <= 0.0 || options.blockSize <= 0)
+            return false;
+
+        options.midiFile = cwd.getChildFile(positional[0]);
+        options.outputFile = cwd.getChildFile(positional[1]);
+        return true;
+    }
+
+    /** All tracks merged into one sequence, timestamped in seconds. */
+    bool readMidi(const juce::File& file, juce::MidiMessageSequence& sequence)
+    {
+        juce::FileInputStream stream(file);
+        juce::MidiFile midi;
+
+        if (!stream.openedOk() || !midi.readFrom(stream))
+            return false;
+
+        midi.convertTimestampTicksToSeconds();
+
+        for (int track = 0; track < midi.getNumTracks(); ++track)
+            sequence.addSequence(*midi.getTrack(track), 0.0);
+
+        sequence.sort();
+        return true;
+    }
+
+    bool loadState(RavelandAudioProcessor& processor, const juce::File& file)
+    {
+        juce::MemoryBlock data;
+        if (!file.loadFileAsData(data))
+            return false;
+
+        // Accept the XML form too, by converting it to the blob a host would pass
+        if (auto xml = juce::parseXML(data.toString()))
+        {
+            data.reset();
+            juce::AudioProcessor::copyXmlToBinary(*xml, data);
+        }
+
+        processor.setStateInformation(data.getData(), (int) data.getSize());
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: RavelandRender <input.mid> <output.wav> [--rate 48000] [--block 512]" << std::endl
+                  << "                      [--preset <index> | --state <file>] [--bits 24] [--tail <seconds>]" << std::endl
+                  << "                      [--trace <file.json>]" << std::endl;
+        return 1;
+    }
+
+    // The parameter tree and sample pool expect a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::MidiMessageSequence sequence;
+    if (!readMidi(options.midiFile, sequence))
+    {
+        std::cerr << "Can't read MIDI file: " << options.midiFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // Started before the processor, so sample and impulse loads are on the timeline
+    auto& trace = TraceRecorder::getInstance();
+    if (options.traceFile != juce::File())
+        trace.start();
+
+    RavelandAudioProcessor processor;
+    processor.setNonRealtime(true);
+
+    if (options.stateFile != juce::File())
+    {
+        if (!loadState(processor, options.stateFile))
+        {
+            std::cerr << "Can't read state file: " << options.stateFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else if (options.preset >= 0)
+    {
+        processor.setCurrentProgram(options.preset);
+    }
+
+    processor.setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+    processor.prepareToPlay(options.sampleRate, options.blockSize);
+
+    // Impulse responses load in the background; don't start without one that was asked for
+    if (processor.getReverbImpulseFile() != juce::File())
+        for (int waited = 0; !processor.isReverbImpulseReady() && waited < 10000; waited += 10)
+            juce::Thread::sleep(10);
+
+    const double tail = options.tailSeconds >= 0.0 ? options.tailSeconds
+                                                   : juce::jmin(processor.getTailLengthSeconds(), 30.0);
+    const auto latency = (juce::int64) processor.getLatencySamples();
+    const auto musicSamples = (juce::int64) std::ceil((sequence.getEndTime() + tail) * options.sampleRate);
+    const auto totalSamples = musicSamples + latency;
+
+    options.outputFile.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(options.outputFile.createOutputStream());
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(stream != nullptr
+        ? wav.createWriterFor(stream.get(), options.sampleRate, 2, options.bitsPerSample, {}, 0) : nullptr);
+
+    if (writer == nullptr)
+    {
+        std::cerr << "Can't write " << options.outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    stream.release(); // owned by the writer now
+
+    juce::AudioBuffer<float> buffer(2, options.blockSize);
+    juce::MidiBuffer midi;
+    int nextEvent = 0;
+    juce::int64 processTicks = 0;
+
+    processor.setTimingEnabled(true);
+
+    for (juce::int64 position = 0; position < totalSamples; position += options.blockSize)
+    {
+        const int numSamples = (int) juce::jmin((juce::int64) options.blockSize, totalSamples - position);
+        const auto blockEnd = position + numSamples;
+
+        midi.clear();
+        for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+        {
+            const auto& message = sequence.getEventPointer(nextEvent)->message;
+            const auto samplePosition = (juce::int64) (message.getTimeStamp() * options.sampleRate);
+            if (samplePosition >= blockEnd)
+                break;
+
+            if (!message.isMetaEvent())
+                midi.addEvent(message, (int) juce::jmax((juce::int64) 0, samplePosition - position));
+        }
+
+        buffer.setSize(2, numSamples, false, false, true);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        processTicks += juce::Time::getHighResolutionTicks() - start;
+
+        // Drop the first `latency` samples so the output lines up with the MIDI
+        const int skip = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, latency - position);
+        if (skip < numSamples)
+            writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip);
+    }
+
+    writer.reset();
+    processor.releaseResources();
+
+    if (options.traceFile != juce::File() && !trace.stop(options.traceFile))
+        std::cerr << "Can't write trace file: " << options.traceFile.getFullPathName() << std::endl;
+
+    const double processSeconds = juce::Time::highResolutionTicksToSeconds(processTicks);
+    const double audioSeconds = (double) musicSamples / options.sampleRate;
+    const auto& timings = processor.getTimings();
+
+    std::cout << "Rendered " << juce::String(audioSeconds, 2) << " s at " << options.sampleRate << " Hz, "
+              << options.blockSize << "-sample blocks, to " << options.outputFile.getFullPathName() << std::endl
+              << "Processing took " << juce::String(processSeconds * 1000.0, 1) << " ms: "
+              << juce::String(processSeconds > 0.0 ? audioSeconds / processSeconds : 0.0, 1) << "x real time, "
+              << DspKernels::get().name << " DSP kernels" << std::endl;
+
+    for (int section = 0; section < RavelandAudioProcessor::ProcessTimings::numSections; ++section)
+    {
+        const double seconds = juce::Time::highResolutionTicksToSeconds(timings.ticks[(size_t) section]);
+        std::cout << "  " << RavelandAudioProcessor::ProcessTimings::getSectionName(section).paddedRight(' ', 12)
+                  << juce::String(seconds * 1000.0, 2).paddedLeft(' ', 10) << " ms"
+                  << juce::String(processSeconds > 0.0 ? 100.0 * seconds / processSeconds : 0.0, 1).paddedLeft(' ', 8) << " %"
+                  << juce::String(seconds * 1.0e9 / (double) totalSamples, 1).paddedLeft(' ', 10) << " ns/sample" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,337 @@
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../source/PluginProcessor.h"
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+/** Worst-case block time under adversarial input.
+
+    Usage: RavelandStress [--rate 48000] [--block 64] [--blocks 20000] [--seed 1]
+                          [--only storm,steal,preset,automation,swap,chain] [--csv blocks.csv]
+
+    Drives the processor back to back with MIDI storms well past the voice count,
+    steal cascades, preset changes and automation of every parameter each block,
+    while a control thread swaps sample stacks and reorders the FX chain underneath
+    it, as the message thread would. Each block is timed and tagged with what happened
+    just before or during it. The report gives p50/p99/p99.9/max against the real-time
+    deadline, a histogram, the slowest blocks with their tags and the tail per tag;
+    --csv writes every block for closer inspection. Exits with 2 if any block missed
+    its deadline. */
+namespace
+{
+    enum Tag
+    {
+        storm       = 1 << 0,  // 64 note-ons at once
+        steal       = 1 << 1,  // a new note while every voice is busy
+        preset      = 1 << 2,  // factory preset change
+        automation  = 1 << 3,  // every parameter moved
+        swap        = 1 << 4,  // a sample stack swapped in by the control thread
+        chain       = 1 << 5,  // FX chain reordered by the control thread
+        numTags     = 6
+    };
+
+    const char* getTagName(int bit)
+    {
+        static const char* const names[numTags] = { "storm", "steal", "preset", "automation", "swap", "chain" };
+        return names[bit];
+    }
+
+    juce::String describeTags(int tags)
+    {
+        juce::StringArray names;
+        for (int bit = 0; bit < numTags; ++bit)
+            if ((tags & (1 << bit)) != 0)
+                names.add(getTagName(bit));
+
+        return names.isEmpty() ? juce::String("-") : names.joinIntoString("+");
+    }
+
+    int parseTags(const juce::String& list)
+    {
+        int tags = 0;
+        for (const auto& name : juce::StringArray::fromTokens(list, ",", ""))
+            for (int bit = 0; bit < numTags; ++bit)
+                if (name.trim() == getTagName(bit))
+                    tags |= 1 << bit;
+
+        return tags;
+    }
+
+    /** Stands in for the message thread: swaps sample stacks and reorders the FX chain
+        at random intervals while the blocks render. */
+    class ControlThread : public juce::Thread
+    {
+    public:
+        ControlThread(RavelandAudioProcessor& p, std::vector<juce::File> stacksToUse, int tagsToRun, int seed)
+            : juce::Thread("RavelandStress control"), processor(p), stacks(std::move(stacksToUse)), tags(tagsToRun), random(seed)
+        {
+        }
+
+        std::atomic<int> swaps { 0 }, chainChanges { 0 };
+
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                if ((tags & swap) != 0 && !stacks.empty() && random.nextBool())
+                {
+                    processor.loadSampleLayer(random.nextInt(3), stacks[(size_t) random.nextInt((int) stacks.size())]);
+                    ++swaps;
+                }
+
+                if ((tags & chain) != 0 && random.nextBool())
+                {
+                    FxChain fx;
+                    for (int i = 0; i < FxChain::numStages * 2; ++i)
+                        fx.moveSlot(random.nextInt(FxChain::numStages), random.nextBool() ? 1 : -1);
+                    for (auto&& enabled : fx.enabled)
+                        enabled = random.nextInt(4) != 0;
+
+                    processor.setFxChain(fx);
+                    ++chainChanges;
+                }
+
+                wait(5 + random.nextInt(20));
+            }
+        }
+
+    private:
+        RavelandAudioProcessor& processor;
+        std::vector<juce::File> stacks;
+        int tags;
+        juce::Random random;
+    };
+
+    /** Writes a short per-key stack of 16-bit notes; `flavour` varies the content. */
+    juce::File writeStack(const juce::File& folder, double sampleRate, int flavour)
+    {
+        folder.createDirectory();
+        juce::AudioBuffer<float> audio(2, (int) sampleRate * 2);
+        juce::WavAudioFormat wav;
+
+        for (int note = 36; note <= 96; note += 6)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < audio.getNumSamples(); ++i)
+                    audio.setSample(ch, i, 0.5f * (float) std::sin(juce::MathConstants<double>::twoPi * (note * 4.0 + flavour * 30.0) * i / sampleRate)
+                                           * std::exp(-2.0f * (float) i / (float) audio.getNumSamples()));
+
+            const auto file = folder.getChildFile(juce::String(note).paddedLeft('0', 3) + ".wav");
+            std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+            std::unique_ptr<juce::AudioFormatWriter> writer(stream != nullptr
+                ? wav.createWriterFor(stream.get(), sampleRate, 2, 16, {}, 0) : nullptr);
+
+            if (writer != nullptr)
+            {
+                stream.release();
+                writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+            }
+        }
+
+        return folder;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        const auto index = (size_t) juce::jlimit(0.0, (double) sorted.size() - 1.0, std::ceil(p * (double) sorted.size()) - 1.0);
+        return sorted[index];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double sampleRate = 48000.0;
+    int blockSize = 64, numBlocks = 20000, seed = 1;
+    int tagsToRun = (1 << numTags) - 1;
+    juce::File csvFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = juce::String::fromUTF8(argv[i]);
+        const auto value = i + 1 < argc ? juce::String::fromUTF8(argv[i + 1]) : juce::String();
+
+        if (arg == "--rate" && value.isNotEmpty())         sampleRate = value.getDoubleValue();
+        else if (arg == "--block" && value.isNotEmpty())   blockSize = value.getIntValue();
+        else if (arg == "--blocks" && value.isNotEmpty())  numBlocks = value.getIntValue();
+        else if (arg == "--seed" && value.isNotEmpty())    seed = value.getIntValue();
+        else if (arg == "--only" && value.isNotEmpty())    tagsToRun = parseTags(value);
+        else if (arg == "--csv" && value.isNotEmpty())     csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else
+        {
+            std::cerr << "Usage: RavelandStress [--rate 48000] [--block 64] [--blocks 20000] [--seed 1]" << std::endl
+                      << "                      [--only storm,steal,preset,automation,swap,chain] [--csv blocks.csv]" << std::endl;
+            return 1;
+        }
+
+        ++i;
+    }
+
+    if (sampleRate <= 0.0 || blockSize <= 0 || numBlocks <= 0 || tagsToRun == 0)
+    {
+        std::cerr << "Nothing to run" << std::endl;
+        return 1;
+    }
+
+    // The parameter tree and sample pool expect a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto workDir = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("RavelandStress");
+    std::vector<juce::File> stacks;
+    if ((tagsToRun & swap) != 0)
+        for (int flavour = 0; flavour < 2; ++flavour)
+            stacks.push_back(writeStack(workDir.getChildFile("stack" + juce::String(flavour)), sampleRate, flavour));
+
+    RavelandAudioProcessor processor;
+    processor.setCurrentProgram(1);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // Every parameter except the master level, which would only mask the rest
+    juce::Array<juce::RangedAudioParameter*> automated;
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            if (ranged->getParameterID() != "masterGain")
+                automated.add(ranged);
+
+    ControlThread control(processor, stacks, tagsToRun, seed + 1);
+    control.startThread();
+
+    juce::Random random(seed);
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    std::vector<double> micros((size_t) numBlocks);
+    std::vector<int> blockTags((size_t) numBlocks);
+    int lastSwaps = 0, lastChainChanges = 0;
+    int nextNote = 0;
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        int tags = 0;
+        midi.clear();
+
+        if ((tagsToRun & storm) != 0 && random.nextInt(200) == 0)
+        {
+            for (int n = 0; n < 64; ++n)
+                midi.addEvent(juce::MidiMessage::noteOn(1, 24 + random.nextInt(84), 0.9f), random.nextInt(blockSize));
+            tags |= storm;
+        }
+
+        if ((tagsToRun & steal) != 0 && random.nextInt(4) == 0)
+        {
+            // Walk upwards through the keyboard, releasing nothing, so each note steals a voice
+            nextNote = (nextNote + 7) % 84;
+            midi.addEvent(juce::MidiMessage::noteOn(1, 24 + nextNote, 0.8f), 0);
+            tags |= steal;
+        }
+
+        if (random.nextInt(50) == 0)
+            midi.addEvent(juce::MidiMessage::allNotesOff(1), 0);
+
+        if ((tagsToRun & preset) != 0 && random.nextInt(100) == 0)
+        {
+            processor.setCurrentProgram(random.nextInt(processor.getNumPrograms()));
+            tags |= preset;
+        }
+
+        if ((tagsToRun & automation) != 0)
+        {
+            for (auto* parameter : automated)
+                parameter->setValueNotifyingHost(random.nextFloat());
+            tags |= automation;
+        }
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        const auto ticks = juce::Time::getHighResolutionTicks() - start;
+
+        // Control-thread actions that landed since the previous block
+        const int swaps = control.swaps.load(), chainChanges = control.chainChanges.load();
+        if (swaps != lastSwaps)
+            tags |= swap;
+        if (chainChanges != lastChainChanges)
+            tags |= chain;
+        lastSwaps = swaps;
+        lastChainChanges = chainChanges;
+
+        micros[(size_t) block] = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+        blockTags[(size_t) block] = tags;
+    }
+
+    control.stopThread(5000);
+    processor.releaseResources();
+
+    // Report
+    const double deadline = blockSize / sampleRate * 1.0e6;
+    auto sorted = micros;
+    std::sort(sorted.begin(), sorted.end());
+    const auto overruns = std::count_if(micros.begin(), micros.end(), [deadline] (double t) { return t > deadline; });
+
+    std::cout << numBlocks << " blocks of " << blockSize << " at " << sampleRate << " Hz, deadline "
+              << juce::String(deadline, 1) << " us, " << (int) overruns << " overruns" << std::endl;
+
+    const std::pair<const char*, double> percentiles[] = { { "p50", 0.5 }, { "p99", 0.99 }, { "p99.9", 0.999 }, { "max", 1.0 } };
+    for (const auto& [name, p] : percentiles)
+    {
+        const auto t = percentile(sorted, p);
+        std::cout << "  " << juce::String(name).paddedRight(' ', 6) << juce::String(t, 1).paddedLeft(' ', 10) << " us"
+                  << juce::String(100.0 * t / deadline, 1).paddedLeft(' ', 8) << " % of deadline" << std::endl;
+    }
+
+    // Log-spaced histogram, in multiples of the deadline
+    std::cout << std::endl << "Histogram (fraction of deadline):" << std::endl;
+    const double edges[] = { 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0, 2.0, 5.0, std::numeric_limits<double>::max() };
+    double lower = 0.0;
+    for (auto upper : edges)
+    {
+        const auto count = std::count_if(micros.begin(), micros.end(),
+                                         [=] (double t) { return t / deadline >= lower && t / deadline < upper; });
+        if (count > 0)
+            std::cout << "  " << (upper < 1.0e9 ? ("< " + juce::String(upper)) : (">= " + juce::String(lower))).paddedRight(' ', 8)
+                      << juce::String((int) count).paddedLeft(' ', 8) << std::endl;
+        lower = upper;
+    }
+
+    std::vector<int> order((size_t) numBlocks);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + juce::jmin(10, numBlocks), order.end(),
+                      [&] (int a, int b) { return micros[(size_t) a] > micros[(size_t) b]; });
+
+    std::cout << std::endl << "Slowest blocks:" << std::endl;
+    for (int i = 0; i < juce::jmin(10, numBlocks); ++i)
+    {
+        const auto b = (size_t) order[(size_t) i];
+        std::cout << "  #" << juce::String((int) b).paddedRight(' ', 8) << juce::String(micros[b], 1).paddedLeft(' ', 10)
+                  << " us  " << describeTags(blockTags[b]) << std::endl;
+    }
+
+    std::cout << std::endl << "Per tag:" << std::endl;
+    for (int bit = 0; bit < numTags; ++bit)
+    {
+        std::vector<double> tagged;
+        for (size_t b = 0; b < micros.size(); ++b)
+            if ((blockTags[b] & (1 << bit)) != 0)
+                tagged.push_back(micros[b]);
+
+        if (tagged.empty())
+            continue;
+
+        std::sort(tagged.begin(), tagged.end());
+        std::cout << "  " << juce::String(getTagName(bit)).paddedRight(' ', 12) << juce::String((int) tagged.size()).paddedLeft(' ', 7) << " blocks"
+                  << "  p99 " << juce::String(percentile(tagged, 0.99), 1).paddedLeft(' ', 9) << " us"
+                  << "  max " << juce::String(tagged.back(), 1).paddedLeft(' ', 9) << " us" << std::endl;
+    }
+
+    if (csvFile != juce::File())
+    {
+        juce::String csv = "block,microseconds,tags\n";
+        for (size_t b = 0; b < micros.size(); ++b)
+            csv << (int) b << "," << juce::String(micros[b], 2) << "," << describeTags(blockTags[b]) << "\n";
+
+        if (!csvFile.replaceWithText(csv))
+            std::cerr << "Can't write " << csvFile.getFullPathName() << std::endl;
+    }
+
+    workDir.deleteRecursively();
+    return overruns > 0 ? 2 : 0;
+}